@@ -74,8 +74,9 @@ void Character::RegisterObject(Context* context)
 void Character::Start()
 {
     // init char anim, so we don't see the t-pose char as it's spawned
-    AnimationController* animCtrl = node_->GetComponent<AnimationController>(true);
-    animCtrl->PlayExclusive("Platforms/Models/BetaLowpoly/Beta_JumpLoop1.ani", 0, true, 0.0f);
+    body_ = GetComponent<RigidBody>();
+    animCtrl_ = node_->GetComponent<AnimationController>(true);
+    animCtrl_->PlayExclusive("Platforms/Models/BetaLowpoly/Beta_JumpLoop1.ani", 0, true, 0.0f);
 
     // anim trigger event
     AnimatedModel *animModel = node_->GetComponent<AnimatedModel>(true);
@@ -87,9 +88,17 @@ void Character::Start()
 
 void Character::FixedUpdate(float timeStep)
 {
-    /// \todo Could cache the components for faster access instead of finding them each frame
-    RigidBody* body = GetComponent<RigidBody>();
-    AnimationController* animCtrl = node_->GetComponent<AnimationController>(true);
+    // components are cached in Start(), look them up again only if they were removed
+    if (!body_)
+        body_ = GetComponent<RigidBody>();
+    if (!animCtrl_)
+        animCtrl_ = node_->GetComponent<AnimationController>(true);
+
+    RigidBody* body = body_;
+    AnimationController* animCtrl = animCtrl_;
+
+    if (!body || !animCtrl)
+        return;
 
     // Update the in air timer. Reset if grounded
     if (!onGround_)
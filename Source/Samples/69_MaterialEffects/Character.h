@@ -28,6 +28,11 @@
 
 using namespace Urho3D;
 
+namespace Urho3D
+{
+class AnimationController;
+}
+
 //=============================================================================
 //=============================================================================
 const int CTRL_FORWARD = 1;
@@ -98,6 +103,10 @@ protected:
     bool isJumping_;
     bool jumpStarted_;
 
+    // cached components
+    WeakPtr<RigidBody> body_;
+    WeakPtr<AnimationController> animCtrl_;
+
     // platform
     bool onMovingPlatform_;
     WeakPtr<RigidBody> platformBody_;
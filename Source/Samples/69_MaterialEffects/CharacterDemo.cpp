@@ -31,13 +31,16 @@
 #include <Urho3D/Graphics/Octree.h>
 #include <Urho3D/Graphics/Renderer.h>
 #include <Urho3D/Graphics/RenderPath.h>
+#include <Urho3D/Graphics/Technique.h>
 #include <Urho3D/Graphics/Zone.h>
 #include <Urho3D/Graphics/BillboardSet.h>
 #include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/Graphics.h>
 #include <Urho3D/Graphics/VertexBuffer.h>
 #include <Urho3D/Input/Controls.h>
 #include <Urho3D/Input/Input.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
 #include <Urho3D/Physics/CollisionShape.h>
 #include <Urho3D/Physics/PhysicsWorld.h>
 #include <Urho3D/Physics/PhysicsEvents.h>
@@ -47,6 +50,7 @@
 #include <Urho3D/Graphics/DebugRenderer.h>
 #include <Urho3D/Scene/Scene.h>
 #include <Urho3D/UI/Font.h>
+#include <Urho3D/UI/Text.h>
 #include <Urho3D/UI/Text3D.h>
 #include <Urho3D/UI/UI.h>
 #include <Urho3D/Engine/DebugHud.h>
@@ -54,8 +58,22 @@
 
 #include "Character.h"
 #include "CharacterDemo.h"
+#include "GlowEffect.h"
+#include "HandleCache.h"
+#include "HeadlessBench.h"
+#include "HullBillboard.h"
+#include "LightmapSet.h"
+#include "LightPathBench.h"
+#include "MaterialAnimator.h"
+#include "ReflectionTargetPool.h"
+#include "RenderTargetFormat.h"
+#include "SceneTimeWrap.h"
+#include "ShaderWarmup.h"
 #include "SplashHandler.h"
 #include "UVSequencer.h"
+#include "VertexAttributeWriter.h"
+#include "WaterReflection.h"
+#include "WaterSurfaceManager.h"
 #include "Touch.h"
 #include "CollisionLayer.h"
 
@@ -64,28 +82,63 @@
 //=============================================================================
 URHO3D_DEFINE_APPLICATION_MAIN(CharacterDemo)
 
+static const StringHash NODE_LIGHTMAPSPHERE("lightmapSphere");
+static const StringHash NODE_VCOLSPHERE("vcolSphere");
+
+static const int iNumVColColors = 13;
+static const unsigned uVColColors[iNumVColColors] = {
+    0xFF00D7FF,  // 0     Gold           = 0xFFFFD700
+    0xFF20A5DA,  // 1     Goldenrod      = 0xFFDAA520
+    0xFFB9DAFF,  // 2     Peachpuff      = 0xFFFFDAB9
+    0xFF008000,  // 3     Green          = 0xFF008000
+    0xFF2FFFAD,  // 4     GreenYellow    = 0xFFADFF2F
+    0xFFF0FFF0,  // 5     Honeydew       = 0xFFF0FFF0
+    0xFFB469FF,  // 6     HotPink        = 0xFFFF69B4
+    0xFF5C5CCD,  // 7     IndianRed      = 0xFFCD5C5C
+    0xFF82004B,  // 8     Indigo         = 0xFF4B0082
+    0xFFD0E040,  // 9     Turquoise      = 0xFF40E0D0
+    0xFF8CE6F0,  // 10    Khaki          = 0xFFF0E68C
+    0xFF9370DB,  // 11    PaleVioletRed  = 0xFFDB7093
+    0xFF1E69D2,  // 12    Chocolate      = 0xFFD2691E
+};
+
 //=============================================================================
 //=============================================================================
 CharacterDemo::CharacterDemo(Context* context)
     : Sample(context)
     , firstPerson_(false)
     , drawDebug_(false)
+    , matAnimBenchCount_(0)
+    , vcolGPUSweep_(false)
+    , vcolForceCPU_(false)
+    , warmupFile_("Data/MaterialEffects/ShaderWarmup.xml")
+    , glowFormat_(TargetFormat_RGBA8)
+    , reflFormat_(TargetFormat_RGB8)
+    , softEffects_(false)
+    , useHWDepth_(false)
+    , hullBillboards_(false)
+    , waterLowQuality_(false)
+    , lightBenchCount_(0)
+    , lightBenchMaxFps_(0)
+    , benchFrames_(0)
+    , benchTimeStep_(1.0f / 60.0f)
+    , avgFrameMSec_(0.0f)
 {
     SplashHandler::RegisterObject(context);
     UVSequencer::RegisterObject(context);
     Character::RegisterObject(context);
-
-    // emission
-    emissionColor_ = Color::BLACK;
-    emissionState_ = EmissionState_R;
+    MaterialAnimator::RegisterObject(context);
+    HullBillboard::RegisterObject(context);
+    SceneTimeWrap::RegisterObject(context);
 
     // lightmap
-    lightmapPathName_ = "Data/MaterialEffects/Textures/checkers-lightmap";
     lightmapIdx_ = 0;
+    lightmapTime_ = 0.0f;
 
     // vcol
     vertIdx_ = 0;
     vcolColorIdx_ = 0;
+    vcolTime_ = 0.0f;
 }
 
 CharacterDemo::~CharacterDemo()
@@ -101,17 +154,105 @@ void CharacterDemo::Setup()
     engineParameters_["WindowWidth"]   = 1280; 
     engineParameters_["WindowHeight"]  = 720;
     engineParameters_["ResourcePaths"] = "Data;CoreData;Data/MaterialEffects;";
+
+    // low water technique by default on mobile and web, other materials keep their quality
+    String platform = GetPlatform();
+    waterLowQuality_ = platform == "Android" || platform == "iOS" || platform == "Web" || platform == "Raspberry Pi";
+
+    // -matanimbench <count>: animate count cloned emissive materials to measure the animator cost
+    const Vector<String>& arguments = GetArguments();
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].ToLower() == "-matanimbench" && i + 1 < arguments.Size())
+        {
+            matAnimBenchCount_ = ToUInt(arguments[i + 1]);
+        }
+        // -vcolcpu: sweep vertex colors on the cpu instead of in the vertex shader
+        else if (arguments[i].ToLower() == "-vcolcpu")
+        {
+            vcolForceCPU_ = true;
+        }
+        // -softfx: depth faded alpha mask effects, renders with a depth texture bound
+        else if (arguments[i].ToLower() == "-softfx")
+        {
+            softEffects_ = true;
+        }
+        // -lightbench <count>: render count point lights with the forward, prepass and deferred paths, log and exit.
+        // no shader warm-up and no water reflection during the run
+        else if (arguments[i].ToLower() == "-lightbench" && i + 1 < arguments.Size())
+        {
+            lightBenchCount_ = ToUInt(arguments[i + 1]);
+        }
+        // -waterquality <low|high>: water technique, distant water uses the low one regardless
+        else if (arguments[i].ToLower() == "-waterquality" && i + 1 < arguments.Size())
+        {
+            waterLowQuality_ = arguments[i + 1].ToLower() == "low";
+        }
+        // -hullfx: draw the flipbook billboards as tight hulls, see SequenceImagePacker -hull
+        else if (arguments[i].ToLower() == "-hullfx")
+        {
+            hullBillboards_ = true;
+        }
+        // -glowformat/-reflformat <rgba8|rgb8|rgba16f|r11g11b10f|rgb10a2|rgb565|rgba4>: render target formats,
+        // unsupported ones fall back
+        else if (arguments[i].ToLower() == "-glowformat" && i + 1 < arguments.Size())
+        {
+            glowFormat_ = RenderTargetFormat::GetType(arguments[i + 1], glowFormat_);
+        }
+        else if (arguments[i].ToLower() == "-reflformat" && i + 1 < arguments.Size())
+        {
+            reflFormat_ = RenderTargetFormat::GetType(arguments[i + 1], reflFormat_);
+        }
+        // -warmup <file>: shader warm-up list, written by the ShaderVariantList tool
+        else if (arguments[i].ToLower() == "-warmup" && i + 1 < arguments.Size())
+        {
+            warmupFile_ = arguments[i + 1];
+        }
+        // -dumpshaders <file>: record the variants used this run, merge it with ShaderVariantList -m
+        else if (arguments[i].ToLower() == "-dumpshaders" && i + 1 < arguments.Size())
+        {
+            dumpShadersFile_ = arguments[i + 1];
+        }
+        // -benchmark <frames>: headless run along BenchData/cameraPath.xml with a fixed time step,
+        // writes cpu timings per section as json and exits
+        else if (arguments[i].ToLower() == "-benchmark" && i + 1 < arguments.Size())
+        {
+            benchFrames_ = ToUInt(arguments[i + 1]);
+        }
+        // -benchstep <seconds>: benchmark time step, 1/60 by default
+        else if (arguments[i].ToLower() == "-benchstep" && i + 1 < arguments.Size())
+        {
+            benchTimeStep_ = ToFloat(arguments[i + 1]);
+        }
+        // -benchout <file>: benchmark json, benchmark.json in the program dir by default
+        else if (arguments[i].ToLower() == "-benchout" && i + 1 < arguments.Size())
+        {
+            benchOutFile_ = arguments[i + 1];
+        }
+    }
+
+    if (benchFrames_ > 0)
+    {
+        engineParameters_["Headless"] = true;
+    }
 }
 
 void CharacterDemo::Start()
 {
+    // headless (benchmark) runs have no window, renderer or debug hud
+    bool headless = engine_->IsHeadless();
+
     // Execute base class startup
-    Sample::Start();
+    if (!headless)
+        Sample::Start();
     if (touchEnabled_)
         touch_ = new Touch(context_, TOUCH_SENSITIVITY);
 
     ChangeDebugHudText();
 
+    if (!dumpShadersFile_.Empty() && !headless)
+        GetSubsystem<Graphics>()->BeginDumpShaders(dumpShadersFile_);
+
     // Create static scene content
     CreateScene();
 
@@ -119,19 +260,166 @@ void CharacterDemo::Start()
 
     CreateSequencers();
 
+    CreateHullBillboards();
+
+    ApplySoftEffects();
+
+    CreateMaterialAnimators();
+
+    CreateLightmapSet();
+
+    CreateVertexColorWriter();
+
     CreateWaterRefection();
 
     // Create the controllable character
     CreateCharacter();
 
     // Create the UI content
-    CreateInstructions();
+    if (!headless)
+        CreateInstructions();
+
+    StartShaderWarmup();
+
+    StartLightBench();
+
+    StartHeadlessBench();
 
     // Subscribe to necessary events
     SubscribeToEvents();
 
     // Set the mouse mode to use in the sample
-    Sample::InitMouseMode(MM_RELATIVE);
+    if (!headless)
+        Sample::InitMouseMode(MM_RELATIVE);
+}
+
+void CharacterDemo::Stop()
+{
+    // writes the recorded variants
+    if (!dumpShadersFile_.Empty() && GetSubsystem<Graphics>())
+        GetSubsystem<Graphics>()->EndDumpShaders();
+
+    Sample::Stop();
+}
+
+void CharacterDemo::StartShaderWarmup()
+{
+    // the light bench measures from its first frames, compiles spread over them would skew the paths it compares
+    if (lightBenchCount_ > 0)
+        return;
+
+    shaderWarmup_ = new ShaderWarmup(context_);
+
+    if (!shaderWarmup_->Start(warmupFile_))
+    {
+        shaderWarmup_.Reset();
+        return;
+    }
+
+    UI* ui = GetSubsystem<UI>();
+    Text* warmupText = ui->GetRoot()->CreateChild<Text>();
+    warmupText->SetFont(GetSubsystem<ResourceCache>()->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
+    warmupText->SetHorizontalAlignment(HA_CENTER);
+    warmupText->SetVerticalAlignment(VA_CENTER);
+    warmupText_ = warmupText;
+}
+
+void CharacterDemo::StartLightBench()
+{
+    if (lightBenchCount_ == 0 || !character_ || !GetSubsystem<Renderer>())
+        return;
+
+    // stand back from the fake BRDF mushrooms and face them, the character stays idle during the run
+    Node *mush1 = scene_->GetChild("mush1", true);
+    Node *mush2 = scene_->GetChild("mush2", true);
+    Vector3 center = mush1 && mush2 ? (mush1->GetWorldPosition() + mush2->GetWorldPosition()) * 0.5f : Vector3::ZERO;
+
+    // input is skipped while the bench runs, so the rotation is set here
+    character_->GetNode()->SetWorldPosition(center + Vector3(0.0f, 0.0f, 10.0f));
+    character_->GetNode()->SetRotation(Quaternion(180.0f, Vector3::UP));
+    character_->controls_.Set(CTRL_FORWARD | CTRL_BACK | CTRL_LEFT | CTRL_RIGHT | CTRL_JUMP, false);
+    character_->controls_.yaw_ = 180.0f;
+    character_->controls_.pitch_ = 10.0f;
+
+    lightBench_ = new LightPathBench(context_);
+
+    if (!lightBench_->Start(GetSubsystem<Renderer>()->GetViewport(0), center, lightBenchCount_))
+    {
+        lightBench_.Reset();
+        return;
+    }
+
+    // measure the light cost, not the frame limiter. restored when the run finishes
+    lightBenchMaxFps_ = engine_->GetMaxFps();
+    engine_->SetMaxFps(0);
+}
+
+void CharacterDemo::StartHeadlessBench()
+{
+    if (benchFrames_ == 0 || !engine_->IsHeadless())
+        return;
+
+    // no frame limiter, the fixed step decides what is simulated and the wall clock only measures.
+    // there is no input focus headless, the inactive limit would apply otherwise
+    engine_->SetMaxFps(0);
+    engine_->SetMaxInactiveFps(0);
+
+    headlessBench_ = new HeadlessBench(context_);
+
+    if (!headlessBench_->Start(scene_, cameraNode_, "Data/MaterialEffects/BenchData/cameraPath.xml", benchFrames_, benchTimeStep_))
+    {
+        headlessBench_.Reset();
+        ErrorExit("headless bench: failed to start, see the log");
+    }
+}
+
+void CharacterDemo::UpdateHeadlessBench()
+{
+    // physics, scene and camera advance by the fixed step, not the frame time
+    headlessBench_->StepScene();
+
+    // the -matanimbench log is left out, it resets the animator stats the bench reads
+    headlessBench_->BeginSection(BenchSection_Effects);
+    UpdateLightmap(headlessBench_->GetTimeStep());
+    UpdateVertexColor(headlessBench_->GetTimeStep());
+    headlessBench_->EndSection(BenchSection_Effects);
+
+    headlessBench_->EndFrame();
+
+    if (headlessBench_->IsFinished())
+    {
+        String outFile = benchOutFile_.Empty() ? GetSubsystem<FileSystem>()->GetProgramDir() + "benchmark.json" : benchOutFile_;
+        bool saved = headlessBench_->SaveJSON(outFile);
+        headlessBench_.Reset();
+
+        if (saved)
+            engine_->Exit();
+        else
+            ErrorExit("headless bench: failed to write " + outFile);
+    }
+}
+
+void CharacterDemo::UpdateShaderWarmup()
+{
+    if (!shaderWarmup_ || !warmupText_)
+        return;
+
+    if (shaderWarmup_->IsFinished())
+    {
+        warmupText_->Remove();
+        return;
+    }
+
+    // text progress bar
+    const int barLength = 40;
+    int filled = (int)(shaderWarmup_->GetProgress() * barLength);
+    String bar;
+    bar.Resize(barLength);
+    for ( int i = 0; i < barLength; ++i )
+        bar[i] = i < filled ? '#' : '.';
+
+    warmupText_->SetText("compiling shaders " + String(shaderWarmup_->GetNumCompiled() + shaderWarmup_->GetNumFailed()) + "/" +
+                         String(shaderWarmup_->GetNumEntries()) + "\n[" + bar + "]");
 }
 
 void CharacterDemo::ChangeDebugHudText()
@@ -161,30 +449,41 @@ void CharacterDemo::CreateScene()
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
     Renderer* renderer = GetSubsystem<Renderer>();
-    Graphics* graphics = GetSubsystem<Graphics>();
 
     scene_ = new Scene(context_);
 
     cameraNode_ = new Node(context_);
     Camera* camera = cameraNode_->CreateComponent<Camera>();
     camera->SetFarClip(300.0f);
+    camera_ = camera;
 
-    SharedPtr<Viewport> viewport(new Viewport(context_, scene_, camera));
-    renderer->SetViewport(0, viewport);
+    targetFormats_ = new RenderTargetFormat(context_);
 
-    // post-process glow
-    SharedPtr<RenderPath> effectRenderPath = viewport->GetRenderPath()->Clone();
-    effectRenderPath->Append(cache->GetResource<XMLFile>("PostProcess/Glow.xml"));
+    // no viewport and post-process headless
+    if (renderer)
+    {
+        SharedPtr<Viewport> viewport(new Viewport(context_, scene_, camera));
+        renderer->SetViewport(0, viewport);
 
-    // set BlurHInvSize to proper value
-    // **note** be sure to do this if screen size changes (not done for this demo)
-    effectRenderPath->SetShaderParameter("BlurHInvSize", Vector2(1.0f/(float)(graphics->GetWidth()), 1.0f/(float)(graphics->GetHeight())));
-    effectRenderPath->SetEnabled("Glow", true);
-    viewport->SetRenderPath(effectRenderPath);
+        // soft effects sample the scene depth, use a path that writes it before the glow is appended
+        if (softEffects_)
+        {
+            useHWDepth_ = GetSubsystem<Graphics>()->GetReadableDepthSupport();
+            viewport->SetRenderPath(cache->GetResource<XMLFile>(useHWDepth_ ? "RenderPaths/ForwardHWDepth.xml" : "RenderPaths/ForwardDepth.xml"));
+        }
+
+        // post-process glow, blur texel sizes follow the screen size
+        glowEffect_ = new GlowEffect(context_);
+        glowEffect_->Init(viewport, cache->GetResource<XMLFile>("PostProcess/Glow.xml"));
+        glowEffect_->SetTargetFormat(targetFormats_->Select(glowFormat_));
+    }
 
     // load scene
     XMLFile *xmlLevel = cache->GetResource<XMLFile>("Data/MaterialEffects/Level1.xml");
     scene_->LoadXML(xmlLevel->GetRoot());
+
+    handleCache_ = new HandleCache(context_);
+    handleCache_->SetScene(scene_);
 }
 
 void CharacterDemo::InitSplashHandler()
@@ -193,6 +492,83 @@ void CharacterDemo::InitSplashHandler()
     splashHandler->LoadSplashList("Data/MaterialEffects/SplashData/splashDataList.xml");
 }
 
+void CharacterDemo::CreateHullBillboards()
+{
+    if (!hullBillboards_)
+        return;
+
+    // before the sequencers' delayed start, they pick up the static models that replace the billboards
+    const char *nodeNames[] = { "explosion", "torch" };
+    const char *hullFiles[] = { "Data/MaterialEffects/HullData/explosionSEQHull.xml", "Data/MaterialEffects/HullData/torchSEQHull.xml" };
+
+    for ( unsigned i = 0; i < 2; ++i )
+    {
+        Node *node = scene_->GetChild(nodeNames[i], true);
+        if (node)
+        {
+            HullBillboard *hullBillboard = node->CreateComponent<HullBillboard>();
+
+            if (!hullBillboard->Create(hullFiles[i], camera_))
+            {
+                hullBillboard->Remove();
+            }
+        }
+    }
+}
+
+void CharacterDemo::ApplySoftEffects()
+{
+    if (!softEffects_)
+        return;
+
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Technique *softTech = cache->GetResource<Technique>("Techniques/DiffUnlitAlphaMaskSoft.xml");
+    Technique *softUVFramesTech = cache->GetResource<Technique>("Techniques/DiffUnlitAlphaMaskUVFramesSoft.xml");
+    unsigned numSwapped = 0;
+
+    // swap the techniques of every loaded alpha mask material, the scene and the splash materials are loaded by now
+    PODVector<Resource*> resources;
+    cache->GetResources(resources, Material::GetTypeStatic());
+
+    for ( unsigned i = 0; i < resources.Size(); ++i )
+    {
+        Material *mat = static_cast<Material*>(resources[i]);
+        bool swapped = false;
+
+        for ( unsigned j = 0; j < mat->GetNumTechniques(); ++j )
+        {
+            const TechniqueEntry &entry = mat->GetTechniqueEntry(j);
+            Technique *tech = entry.technique_;
+
+            if (!tech)
+                continue;
+
+            if (tech->GetName() == "Techniques/DiffUnlitAlphaMask.xml" && softTech)
+            {
+                mat->SetTechnique(j, softTech, entry.qualityLevel_, entry.lodDistance_);
+                swapped = true;
+            }
+            else if (tech->GetName() == "Techniques/DiffUnlitAlphaMaskUVFrames.xml" && softUVFramesTech)
+            {
+                mat->SetTechnique(j, softUVFramesTech, entry.qualityLevel_, entry.lodDistance_);
+                swapped = true;
+            }
+        }
+
+        if (swapped)
+        {
+            if (useHWDepth_ && !mat->GetPixelShaderDefines().Contains("HWDEPTH"))
+            {
+                String defines = mat->GetPixelShaderDefines();
+                mat->SetPixelShaderDefines(defines.Empty() ? String("HWDEPTH") : defines + " HWDEPTH");
+            }
+            ++numSwapped;
+        }
+    }
+
+    URHO3D_LOGINFO("soft effects: " + String(numSwapped) + " materials, " + String(useHWDepth_ ? "hw depth" : "depth target"));
+}
+
 void CharacterDemo::CreateSequencers()
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
@@ -239,14 +615,98 @@ void CharacterDemo::CreateSequencers()
         uvSequencer->LoadXML(xmlLevel->GetRoot());
     }
 
-    Node *lavaUNode = scene_->GetChild("lava", true);
-    if (lavaUNode)
+    // waterfall and lava scroll in their shaders from the scene elapsed time (UVScrollSpeed material parameter),
+    // the time is kept in double and wrapped so long uptimes don't lose precision.
+    // every scroll/noise speed in the level times the period is a whole number of repeats
+    SceneTimeWrap *timeWrap = scene_->CreateComponent<SceneTimeWrap>();
+    timeWrap->SetWrapPeriod(1000.0f);
+}
+
+void CharacterDemo::CreateMaterialAnimators()
+{
+    matAnimator_ = scene_->CreateComponent<MaterialAnimator>();
+    matAnimator_->LoadTracks("Data/MaterialEffects/MaterialAnimData/emissionCycle.xml");
+
+    if (matAnimBenchCount_ == 0)
     {
-        UVSequencer *uvSequencer = lavaUNode->CreateComponent<UVSequencer>();
-        XMLFile *xmlLevel = cache->GetResource<XMLFile>("Data/MaterialEffects/UVSequencerData/lavaVScrollSeqData.xml");
-        uvSequencer->LoadXML(xmlLevel->GetRoot());
+        return;
+    }
+
+    // stress setup, the same emission cycle on clones of the emissive material with staggered offsets
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Material *srcMat = cache->GetResource<Material>("MaterialEffects/Materials/sphEmissiveMat.xml");
+
+    if (!srcMat)
+    {
+        return;
+    }
+
+    PODVector<MatAnimKey> keys(7);
+    const Color keyColors[7] = { Color::BLACK, Color::RED, Color::BLACK, Color::GREEN, Color::BLACK, Color::BLUE, Color::BLACK };
+    for ( unsigned i = 0; i < keys.Size(); ++i )
+    {
+        keys[i].time_ = 1.5f * (float)i;
+        keys[i].value_ = keyColors[i].ToVector4();
+    }
+
+    matAnimBench_ = scene_->CreateComponent<MaterialAnimator>();
+
+    for ( unsigned i = 0; i < matAnimBenchCount_; ++i )
+    {
+        SharedPtr<Material> mat = srcMat->Clone();
+        matAnimBench_->AddTrack(mat, "MatEmissiveColor", MatAnimTrack_Color, keys, MatAnimWrap_Loop, 0.01f * (float)i);
+    }
+
+    matAnimBenchTimer_.Reset();
+}
+
+void CharacterDemo::CreateLightmapSet()
+{
+    // all lightmaps are loaded and bound up front, cycling only writes the weights
+    lightmapSet_ = new LightmapSet(context_);
+    if (!lightmapSet_->Load("Data/MaterialEffects/Textures/checkers-lightmap", ".png", Max_Lightmaps))
+    {
+        URHO3D_LOGWARNING("lightmap set: failed to load the checkers lightmaps, lightmap cycling disabled");
+        lightmapSet_.Reset();
+        return;
     }
 
+    StaticModel *lightmapModel = handleCache_->GetComponent<StaticModel>(NODE_LIGHTMAPSPHERE);
+    if (lightmapModel)
+    {
+        lightmapSet_->Apply(lightmapModel->GetMaterial());
+    }
+    lightmapTime_ = 0.0f;
+}
+
+void CharacterDemo::CreateVertexColorWriter()
+{
+    vcolWriter_ = new VertexAttributeWriter(context_);
+
+    StaticModel *vcolModel = handleCache_->GetComponent<StaticModel>(NODE_VCOLSPHERE);
+    if (vcolModel && vcolModel->GetModel())
+    {
+        const Vector<SharedPtr<VertexBuffer> > &vbuffers = vcolModel->GetModel()->GetVertexBuffers();
+        if (vbuffers.Size())
+        {
+            vcolWriter_->SetBuffer(vbuffers[0]);
+        }
+
+        // gpu sweep: bake each vertex's order into its color once, the shader
+        // compares it against the sweep uniform, the cpu path stays as fallback
+        if (!vcolForceCPU_ && vcolWriter_->GetElementOffset(SEM_COLOR) != M_MAX_UNSIGNED &&
+            vcolWriter_->GetNumVertices() <= 0xFFFFFF)
+        {
+            for ( unsigned i = 0; i < vcolWriter_->GetNumVertices(); ++i )
+            {
+                vcolWriter_->SetColor(i, 0xFF000000 | i);
+            }
+
+            ResourceCache* cache = GetSubsystem<ResourceCache>();
+            vcolModel->SetMaterial(cache->GetResource<Material>("MaterialEffects/Materials/whiteVColSweepMat.xml"));
+            vcolGPUSweep_ = true;
+        }
+    }
 }
 
 void CharacterDemo::CreateCharacter()
@@ -294,38 +754,25 @@ void CharacterDemo::CreateCharacter()
 
 void CharacterDemo::CreateWaterRefection()
 {
-    // right out of 23_Water sample
-    Graphics* graphics = GetSubsystem<Graphics>();
-    Renderer* renderer = GetSubsystem<Renderer>();
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-    waterNode_ = scene_->GetChild("waterGround", true);
-    waterNode_->GetComponent<StaticModel>()->SetViewMask(0x80000000);
-
-    waterPlane_ = Plane(waterNode_->GetWorldRotation() * Vector3(0.0f, 1.0f, 0.0f), waterNode_->GetWorldPosition());
-    waterClipPlane_ = Plane(waterNode_->GetWorldRotation() * Vector3(0.0f, 1.0f, 0.0f), waterNode_->GetWorldPosition() - Vector3(0.0f, 0.1f, 0.0f));
-
-    reflectionCameraNode_ = cameraNode_->CreateChild();
-    Camera* reflectionCamera = reflectionCameraNode_->CreateComponent<Camera>();
-    reflectionCamera->SetFarClip(750.0);
-    reflectionCamera->SetViewMask(0x7fffffff); // Hide objects with only bit 31 in the viewmask (the water plane)
-    reflectionCamera->SetAutoAspectRatio(false);
-    reflectionCamera->SetUseReflection(true);
-    reflectionCamera->SetReflectionPlane(waterPlane_);
-    reflectionCamera->SetUseClipping(true); // Enable clipping of geometry behind water plane
-    reflectionCamera->SetClipPlane(waterClipPlane_);
-    reflectionCamera->SetAspectRatio((float)graphics->GetWidth() / (float)graphics->GetHeight());
-
-    int texSize = 1024;
-    SharedPtr<Texture2D> renderTexture(new Texture2D(context_));
-    renderTexture->SetSize(texSize, texSize, Graphics::GetRGBFormat(), TEXTURE_RENDERTARGET);
-    renderTexture->SetFilterMode(FILTER_BILINEAR);
-    RenderSurface* surface = renderTexture->GetRenderSurface();
-    SharedPtr<Viewport> rttViewport(new Viewport(context_, scene_, reflectionCamera));
-    surface->SetViewport(0, rttViewport);
-    Material* waterMat = cache->GetResource<Material>("MaterialEffects/Materials/waterGroundMat.xml");
-    waterMat->SetTexture(TU_SPECULAR, renderTexture);
+    // reflections are rendered views, nothing to do headless
+    if (!GetSubsystem<Renderer>())
+        return;
 
+    // started out of 23_Water sample, water surfaces on the same plane share one reflection
+    waterSurfaces_ = new WaterSurfaceManager(context_);
+    waterSurfaces_->Init(scene_, cameraNode_);
+    waterSurfaces_->GetTargetPool()->SetFormat(targetFormats_->Select(reflFormat_));
+    waterSurfaces_->SetFrameBudget(1000.0f / 60.0f);
+    waterSurfaces_->SetUpdateInterval(3);
+    waterSurfaces_->SetMotionThreshold(0.5f, 4.0f);
+    waterSurfaces_->SetLowQuality(waterLowQuality_);
+
+    if (waterSurfaces_->AddTaggedSurfaces("water") == 0)
+    {
+        waterSurfaces_->AddSurface(scene_->GetChild("waterGround", true));
+    }
 }
+
 void CharacterDemo::CreateInstructions()
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
@@ -340,6 +787,14 @@ void CharacterDemo::CreateInstructions()
     instructionText->SetHorizontalAlignment(HA_CENTER);
     instructionText->SetVerticalAlignment(VA_CENTER);
     instructionText->SetPosition(0, ui->GetRoot()->GetHeight() / 4);
+
+    // render stats readout, hidden until toggled with F5
+    Text* statsText = ui->GetRoot()->CreateChild<Text>();
+    statsText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 12);
+    statsText->SetColor(Color::CYAN);
+    statsText->SetPosition(10, 10);
+    statsText->SetVisible(false);
+    statsText_ = statsText;
 }
 
 void CharacterDemo::SubscribeToEvents()
@@ -357,7 +812,14 @@ void CharacterDemo::HandleUpdate(StringHash eventType, VariantMap& eventData)
     Input* input = GetSubsystem<Input>();
     float timeStep = eventData[P_TIMESTEP].GetFloat();
 
-    if (character_)
+    if (headlessBench_)
+    {
+        UpdateHeadlessBench();
+        return;
+    }
+
+    // the light bench holds the character still
+    if (character_ && !lightBench_)
     {
         // Clear previous controls
         character_->controls_.Set(CTRL_FORWARD | CTRL_BACK | CTRL_LEFT | CTRL_RIGHT | CTRL_JUMP, false);
@@ -387,7 +849,7 @@ void CharacterDemo::HandleUpdate(StringHash eventType, VariantMap& eventData)
                     TouchState* state = input->GetTouch(i);
                     if (!state->touchedElement_)    // Touch on empty space
                     {
-                        Camera* camera = cameraNode_->GetComponent<Camera>();
+                        Camera* camera = camera_;
                         if (!camera)
                             return;
 
@@ -413,8 +875,18 @@ void CharacterDemo::HandleUpdate(StringHash eventType, VariantMap& eventData)
         }
     }
 
+    UpdateShaderWarmup();
+
+    if (lightBench_ && lightBench_->IsFinished())
+    {
+        lightBench_.Reset();
+        engine_->SetMaxFps(lightBenchMaxFps_);
+        engine_->Exit();
+        return;
+    }
+
     // update material effects
-    UpdateEmission(timeStep);
+    UpdateMaterialAnimBench();
     UpdateLightmap(timeStep);
     UpdateVertexColor(timeStep);
 
@@ -422,16 +894,84 @@ void CharacterDemo::HandleUpdate(StringHash eventType, VariantMap& eventData)
     if (input->GetKeyPress(KEY_F4))
         drawDebug_ = !drawDebug_;
 
-    // In case resolution has changed, adjust the reflection camera aspect ratio
-    Graphics* graphics = GetSubsystem<Graphics>();
-    Camera* reflectionCamera = reflectionCameraNode_->GetComponent<Camera>();
-    reflectionCamera->SetAspectRatio((float)graphics->GetWidth() / (float)graphics->GetHeight());
+    if (input->GetKeyPress(KEY_F5) && statsText_)
+        statsText_->SetVisible(!statsText_->IsVisible());
 
+    if (input->GetKeyPress(KEY_F7))
+        LogTargetMemory();
+
+    // compare glow blur modes
+    if (input->GetKeyPress(KEY_F6) && glowEffect_)
+        glowEffect_->SetBlurMode(glowEffect_->GetBlurMode() == GlowBlur_Gaussian ? GlowBlur_DualFilter : GlowBlur_Gaussian);
+
+    UpdateStatsText(timeStep);
+}
+
+void CharacterDemo::LogTargetMemory()
+{
+    String report("render target memory (color only)\n");
+    unsigned totalBytes = 0;
+
+    if (glowEffect_)
+        totalBytes += glowEffect_->AppendMemoryReport(report);
+    if (waterSurfaces_)
+        totalBytes += waterSurfaces_->GetTargetPool()->AppendMemoryReport(report);
+
+    report.AppendWithFormat("  total %u bytes", totalBytes);
+    URHO3D_LOGINFO(report);
+}
+
+void CharacterDemo::UpdateStatsText(float timeStep)
+{
+    avgFrameMSec_ = Lerp(avgFrameMSec_, timeStep * 1000.0f, 0.05f);
+
+    if (!statsText_ || !statsText_->IsVisible() || !waterSurfaces_)
+        return;
+
+    String stats;
+    stats.AppendWithFormat("frame %.2f ms\n", avgFrameMSec_);
+
+    if (shaderWarmup_)
+        stats.AppendWithFormat("shader warmup: %u/%u compiled, %u failed, %.1f ms total, %.1f ms max\n",
+                               shaderWarmup_->GetNumCompiled(), shaderWarmup_->GetNumEntries(), shaderWarmup_->GetNumFailed(),
+                               shaderWarmup_->GetTotalMSec(), shaderWarmup_->GetMaxMSec());
+
+    if (glowEffect_)
+    {
+        // no gpu timer queries in the engine, the fetch count is the cost estimate to compare modes with
+        if (glowEffect_->GetBlurMode() == GlowBlur_Gaussian)
+            stats.Append("glow blur: gaussian (F6)\n");
+        else
+            stats.AppendWithFormat("glow blur: dual filter, %u levels (F6)\n", glowEffect_->GetDualFilterLevels());
+
+        if (glowEffect_->IsActive())
+            stats.AppendWithFormat("  pixels %.2fM  fetches %.2fM\n", glowEffect_->GetBlurPixels() / 1000000.0f,
+                                   glowEffect_->GetBlurFetches() / 1000000.0f);
+        else
+            stats.Append("  skipped, no glow in view\n");
+    }
+
+    stats.AppendWithFormat("water quality: %s\n", waterSurfaces_->GetLowQuality() ? "low" : "high");
+    stats.AppendWithFormat("water surfaces %u, reflections %u, targets %u\n", waterSurfaces_->GetNumSurfaces(),
+                           waterSurfaces_->GetNumReflections(), waterSurfaces_->GetTargetPool()->GetNumAllocated());
+
+    for ( unsigned i = 0; i < waterSurfaces_->GetNumReflections(); ++i )
+    {
+        WaterReflection *reflection = waterSurfaces_->GetReflection(i);
+
+        stats.AppendWithFormat("reflection %u: %dx%d %s\n", i, reflection->GetTextureSize(), reflection->GetTextureSize(),
+                               reflection->IsUpdating() ? "" : "(not rendered)");
+        stats.AppendWithFormat("  batches %u (%.0f%%)  triangles %u (%.0f%%)\n",
+                               reflection->GetNumBatches(), reflection->GetBatchShare() * 100.0f,
+                               reflection->GetNumPrimitives(), reflection->GetPrimitiveShare() * 100.0f);
+    }
+    statsText_->SetText(stats);
 }
 
 void CharacterDemo::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
 {
-    if (!character_)
+    // the benchmark camera follows its path
+    if (!character_ || headlessBench_)
         return;
 
     using namespace Update;
@@ -466,6 +1006,13 @@ void CharacterDemo::HandlePostUpdate(StringHash eventType, VariantMap& eventData
         cameraNode_->SetPosition(aimPoint + rayDir * rayDistance + wallHitNormal_);
         cameraNode_->SetRotation(dir);
     }
+
+    // queue the reflection only after the camera has settled for the frame. the reflection is a manual
+    // update target, skipping it keeps its view out of the light bench's batch counts
+    if (waterSurfaces_ && !lightBench_)
+    {
+        waterSurfaces_->Update(timeStep);
+    }
 }
 
 
@@ -477,148 +1024,94 @@ void CharacterDemo::HandlePostRenderUpdate(StringHash eventType, VariantMap& eve
     }
 }
 
-void CharacterDemo::UpdateEmission(float timeStep)
+void CharacterDemo::UpdateMaterialAnimBench()
 {
-    Node *emissionNode = scene_->GetChild("emissionSphere1");
-    if (emissionNode)
+    if (!matAnimBench_ || matAnimBenchTimer_.GetMSec(false) < 5000)
     {
-        if (!emissionNode->GetComponent<StaticModel>()->IsInView(cameraNode_->GetComponent<Camera>()))
-            return;
+        return;
     }
 
-    timeStep *= 2.0f;
-    switch (emissionState_)
-    {
-    case EmissionState_R:
-        emissionColor_ = emissionColor_.Lerp(Color::RED, timeStep);
-        if (emissionColor_.r_ > 0.99f)
-        {
-            emissionState_ = EmissionState_None1;
-        }
-        break;
-
-    case EmissionState_G:
-        emissionColor_ = emissionColor_.Lerp(Color::GREEN, timeStep);
-        if (emissionColor_.g_ > 0.99f)
-        {
-            emissionState_ = EmissionState_None2;
-        }
-        break;
+    URHO3D_LOGINFOF("MaterialAnimator bench: %u tracks, %.2f usec/frame avg",
+                    matAnimBench_->GetNumTracks(), matAnimBench_->GetAverageUpdateUSec());
 
-    case EmissionState_B:
-        emissionColor_ = emissionColor_.Lerp(Color::BLUE, timeStep);
-        if (emissionColor_.b_ > 0.99f)
-        {
-            emissionState_ = EmissionState_None3;
-        }
-        break;
-
-    case EmissionState_None1:
-    case EmissionState_None2:
-    case EmissionState_None3:
-        emissionColor_ = emissionColor_.Lerp(Color::BLACK, timeStep);
-        if (emissionColor_.SumRGB() < 0.01f)
-        {
-            emissionState_ = ++emissionState_ % EmissionState_MAX;
-        }
-    }
-
-    if (emissionNode)
-    {
-        Material *mat = emissionNode->GetComponent<StaticModel>()->GetMaterial();
-        mat->SetShaderParameter("MatEmissiveColor", emissionColor_);
-    }
+    matAnimBench_->ResetUpdateStats();
+    matAnimBenchTimer_.Reset();
 }
 
 void CharacterDemo::UpdateLightmap(float timeStep)
 {
-    if (lightmapTimer_.GetMSec(false) > 1000)
-    {
-        Node *lightmapNode = scene_->GetChild("lightmapSphere");
-        lightmapIdx_ = ++lightmapIdx_ % Max_Lightmaps;
+    const float holdTime = 1.0f;
+    const float fadeTime = 0.25f;
+    unsigned numLightmaps = lightmapSet_ ? lightmapSet_->GetNumLightmaps() : 0;
 
-        if (lightmapNode)
-        {
-            char buf[10];
-            sprintf(buf, "%03d.png", lightmapIdx_);
-            String diffName = lightmapPathName_ + String(buf);
+    if (numLightmaps == 0)
+    {
+        return;
+    }
 
-            ResourceCache* cache = GetSubsystem<ResourceCache>();
-            Material *mat = lightmapNode->GetComponent<StaticModel>()->GetMaterial();
-            mat->SetTexture(TU_EMISSIVE, cache->GetResource<Texture2D>(diffName));
-        }
+    // driven by the update time step, the benchmark's fixed step gives the same sequence on every machine
+    lightmapTime_ += timeStep;
+    unsigned nextIdx = (lightmapIdx_ + 1) % numLightmaps;
 
-        lightmapTimer_.Reset();
+    if (lightmapTime_ >= holdTime + fadeTime)
+    {
+        lightmapIdx_ = nextIdx;
+        lightmapSet_->SetLightmap(lightmapIdx_);
+        lightmapTime_ = 0.0f;
+    }
+    else if (lightmapTime_ > holdTime)
+    {
+        // cross-fade into the next lightmap
+        lightmapSet_->SetBlend(lightmapIdx_, nextIdx, (lightmapTime_ - holdTime) / fadeTime);
     }
 }
 
 void CharacterDemo::UpdateVertexColor(float timeStep)
 {
-    const int iNumColors = 13;
-    const unsigned uColors[iNumColors] = {
-        0xFF00D7FF,  // 0     Gold           = 0xFFFFD700
-        0xFF20A5DA,  // 1     Goldenrod      = 0xFFDAA520
-        0xFFB9DAFF,  // 2     Peachpuff      = 0xFFFFDAB9
-        0xFF008000,  // 3     Green          = 0xFF008000
-        0xFF2FFFAD,  // 4     GreenYellow    = 0xFFADFF2F
-        0xFFF0FFF0,  // 5     Honeydew       = 0xFFF0FFF0
-        0xFFB469FF,  // 6     HotPink        = 0xFFFF69B4
-        0xFF5C5CCD,  // 7     IndianRed      = 0xFFCD5C5C
-        0xFF82004B,  // 8     Indigo         = 0xFF4B0082
-        0xFFD0E040,  // 9     Turquoise      = 0xFF40E0D0
-        0xFF8CE6F0,  // 10    Khaki          = 0xFFF0E68C
-        0xFF9370DB,  // 11    PaleVioletRed  = 0xFFDB7093
-        0xFF1E69D2,  // 12    Chocolate      = 0xFFD2691E
-    };
-
-    if (vcolTimer_.GetMSec(false) > 1)
-    {
-        Node *vcolsphNode = scene_->GetChild("vcolSphere");
-
-        if (vcolsphNode)
+    // at most one vertex per update, once more than a millisecond of update time has passed
+    vcolTime_ += timeStep;
+
+    if (vcolTime_ > 0.001f)
+    {
+        StaticModel *vcolModel = handleCache_->GetComponent<StaticModel>(NODE_VCOLSPHERE);
+
+        if (vcolModel)
         {
-            if (!vcolsphNode->GetComponent<StaticModel>()->IsInView(cameraNode_->GetComponent<Camera>()))
+            // nothing is in view headless, the benchmark measures the update regardless
+            if (!headlessBench_ && !vcolModel->IsInView(camera_))
                 return;
 
-            Model *model = vcolsphNode->GetComponent<StaticModel>()->GetModel();
-            Geometry *geometry = model->GetGeometry(0, 0);
-            const Vector<SharedPtr<VertexBuffer> > &vbuffers = model->GetVertexBuffers();
-            SharedPtr<VertexBuffer> vbuffer = vbuffers[0];
-            unsigned elementMask = vbuffer->GetElementMask();
-
-            if (!(elementMask & MASK_COLOR))
+            // no color element, or the buffer could not be copied
+            if (vcolWriter_->GetElementOffset(SEM_COLOR) == M_MAX_UNSIGNED)
             {
                 return;
             }
 
-            unsigned vertexSize = vbuffer->GetVertexSize();
-            unsigned numVertices = vbuffer->GetVertexCount();
-            const unsigned char *vertexData = (const unsigned char*)vbuffer->Lock(0, vbuffer->GetVertexCount());
-
-            if (vertexData)
+            if (vcolGPUSweep_)
             {
-                unsigned char *dataAlign = (unsigned char *)(vertexData + vertIdx_ * vertexSize);
-
-                // get the alignment to the vertex color
-                if ( elementMask & MASK_POSITION ) dataAlign += sizeof(Vector3);
-                if ( elementMask & MASK_NORMAL )   dataAlign += sizeof(Vector3);
-
-                unsigned &uColor = *reinterpret_cast<unsigned*>(dataAlign);
-                uColor = uColors[vcolColorIdx_];
-
-                vbuffer->Unlock();
+                // only uniforms change, vertices behind the sweep take the current color
+                Color curColor, prevColor;
+                curColor.FromUInt(uVColColors[vcolColorIdx_]);
+                prevColor.FromUInt(uVColColors[(vcolColorIdx_ + iNumVColColors - 1) % iNumVColColors]);
+
+                Material *mat = vcolModel->GetMaterial();
+                mat->SetShaderParameter("VColSweep", Vector4((float)(vertIdx_ + 1), 0.0f, 0.0f, 0.0f));
+                mat->SetShaderParameter("VColCurrent", curColor);
+                mat->SetShaderParameter("VColPrevious", prevColor);
             }
-            if (++vertIdx_ >= numVertices)
+            else
+            {
+                // written to the cpu copy, the dirty range is uploaded at render update
+                vcolWriter_->SetColor(vertIdx_, uVColColors[vcolColorIdx_]);
+            }
+
+            if (++vertIdx_ >= vcolWriter_->GetNumVertices())
             {
                 vertIdx_ = 0;
-                vcolColorIdx_ = ++vcolColorIdx_ % iNumColors;
+                vcolColorIdx_ = ++vcolColorIdx_ % iNumVColColors;
             }
         }
 
-        vcolTimer_.Reset();
+        vcolTime_ = 0.0f;
     }
 }
-
-
-
-
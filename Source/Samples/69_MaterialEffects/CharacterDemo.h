@@ -23,30 +23,31 @@
 #pragma once
 
 #include "Sample.h"
+#include "RenderTargetFormat.h"
 
 namespace Urho3D
 {
 
+class Camera;
 class Node;
 class Scene;
+class Text;
 
 }
 
 class Character;
+class GlowEffect;
+class HandleCache;
+class HeadlessBench;
+class LightmapSet;
+class LightPathBench;
+class MaterialAnimator;
+class ShaderWarmup;
 class Touch;
+class VertexAttributeWriter;
+class WaterSurfaceManager;
 //=============================================================================
 //=============================================================================
-enum EmissionState
-{
-    EmissionState_R,
-    EmissionState_None1,
-    EmissionState_G,
-    EmissionState_None2,
-    EmissionState_B,
-    EmissionState_None3,
-    EmissionState_MAX,
-};
-
 enum LightmapType
 {
     Max_Lightmaps = 3
@@ -67,6 +68,7 @@ public:
     virtual void Setup();
     /// Setup after engine initialization and before running the main loop.
     virtual void Start();
+    virtual void Stop();
 
 protected:
     /// Return XML patch instructions for screen joystick layout for a specific sample app, if any.
@@ -133,9 +135,21 @@ protected:
     void HandlePostRenderUpdate(StringHash eventType, VariantMap& eventData);
 
     void CreateSequencers();
+    void CreateHullBillboards();
+    void ApplySoftEffects();
     void CreateWaterRefection();
-
-    void UpdateEmission(float timeStep);
+    void CreateMaterialAnimators();
+    void CreateLightmapSet();
+    void CreateVertexColorWriter();
+
+    void StartShaderWarmup();
+    void StartLightBench();
+    void StartHeadlessBench();
+    void UpdateHeadlessBench();
+    void UpdateShaderWarmup();
+    void UpdateMaterialAnimBench();
+    void UpdateStatsText(float timeStep);
+    void LogTargetMemory();
     void UpdateLightmap(float timeStep);
     void UpdateVertexColor(float timeStep);
 
@@ -146,29 +160,68 @@ protected:
     WeakPtr<Character> character_;
     /// First person camera flag.
     bool firstPerson_;
+    /// Node and component lookups used by the per-frame effect updates.
+    SharedPtr<HandleCache> handleCache_;
+    WeakPtr<Camera> camera_;
 
-    // emission
-    Color emissionColor_;
-    Timer emissionTimer_;
-    int   emissionState_;
+    // material animation
+    WeakPtr<MaterialAnimator> matAnimator_;
+    WeakPtr<MaterialAnimator> matAnimBench_;
+    unsigned matAnimBenchCount_;
+    Timer    matAnimBenchTimer_;
 
     // lightmap
-    String lightmapPathName_;
-    Timer  lightmapTimer_;
-    int    lightmapIdx_;
+    SharedPtr<LightmapSet> lightmapSet_;
+    float    lightmapTime_;
+    unsigned lightmapIdx_;
 
     // vcol
+    SharedPtr<VertexAttributeWriter> vcolWriter_;
+    bool     vcolGPUSweep_;
+    bool     vcolForceCPU_;
     int      vcolColorIdx_;
     unsigned vertIdx_;
-    Timer    vcolTimer_;
+    float    vcolTime_;
+
+    // shader warm-up
+    SharedPtr<ShaderWarmup> shaderWarmup_;
+    WeakPtr<Text> warmupText_;
+    String warmupFile_;
+    String dumpShadersFile_;
+
+    // render target formats, unsupported choices fall back
+    SharedPtr<RenderTargetFormat> targetFormats_;
+    TargetFormatType glowFormat_;
+    TargetFormatType reflFormat_;
+
+    // soft alpha mask effects
+    bool softEffects_;
+    bool useHWDepth_;
+
+    // flipbook billboards drawn as tight hulls
+    bool hullBillboards_;
+
+    // glow
+    SharedPtr<GlowEffect> glowEffect_;
 
     // water reflection
-    SharedPtr<Node> reflectionCameraNode_;
-    SharedPtr<Node> waterNode_;
-    Plane waterPlane_;
-    Plane waterClipPlane_;
+    SharedPtr<WaterSurfaceManager> waterSurfaces_;
+    bool waterLowQuality_;
+
+    // light count benchmark
+    SharedPtr<LightPathBench> lightBench_;
+    unsigned lightBenchCount_;
+    int lightBenchMaxFps_;
+
+    // headless benchmark
+    SharedPtr<HeadlessBench> headlessBench_;
+    unsigned benchFrames_;
+    float    benchTimeStep_;
+    String   benchOutFile_;
 
     // dbg
+    WeakPtr<Text> statsText_;
+    float avgFrameMSec_;
     Vector3 wallHitNormal_;
     bool drawDebug_;
 };
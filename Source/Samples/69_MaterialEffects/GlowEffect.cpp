@@ -0,0 +1,534 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Drawable.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/RenderPath.h>
+#include <Urho3D/Graphics/Technique.h>
+#include <Urho3D/Graphics/View.h>
+#include <Urho3D/Graphics/Viewport.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#include "GlowEffect.h"
+#include "RenderTargetFormat.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+static const char* GLOW_TAG = "Glow";
+static const char* GLOW_GAUSSIAN_TAG = "GlowGaussian";
+static const char* GLOW_DUAL_TAG = "GlowDualFilter";
+static const char* GLOW_DEPTH_NAME = "glowdepth";
+
+//=============================================================================
+//=============================================================================
+GlowEffect::GlowEffect(Context *context)
+    : Object(context)
+    , blurMode_(GlowBlur_Gaussian)
+    , dualLevels_(4)
+    , targetFormat_(Graphics::GetRGBAFormat())
+    , enabled_(false)
+    , skipWhenIdle_(true)
+    , glowVisible_(true)
+    , glowRect_(-1.0f, -1.0f, 1.0f, 1.0f)
+    , blurRadius_(0.0f)
+    , blurPixels_(0)
+    , blurFetches_(0)
+{
+}
+
+bool GlowEffect::Init(Viewport *viewport, XMLFile *glowRenderPath)
+{
+    if (!viewport || !glowRenderPath)
+    {
+        return false;
+    }
+
+    viewport_ = viewport;
+
+    // appended once, resizes only touch command parameters and the view reallocates its own screen buffers
+    renderPath_ = viewport->GetRenderPath()->Clone();
+
+    // the glow mask renders the scene's depth into its own half size depth-stencil, so it does not depend
+    // on the path's depth buffer or its multisampling
+    renderPath_->Append(glowRenderPath);
+
+    viewport->SetRenderPath(renderPath_);
+
+    BuildDualFilterChain();
+    SetGlowRect(glowRect_);
+    SetEnabled(true);
+
+    SubscribeToEvent(E_SCREENMODE, URHO3D_HANDLER(GlowEffect, HandleScreenMode));
+    SubscribeToEvent(E_ENDVIEWUPDATE, URHO3D_HANDLER(GlowEffect, HandleEndViewUpdate));
+
+    return true;
+}
+
+void GlowEffect::SetEnabled(bool enable)
+{
+    enabled_ = enable;
+
+    UpdateEnabledTags();
+}
+
+void GlowEffect::SetSkipWhenIdle(bool skip)
+{
+    skipWhenIdle_ = skip;
+
+    UpdateEnabledTags();
+}
+
+void GlowEffect::SetBlurMode(GlowBlurMode mode)
+{
+    blurMode_ = mode;
+
+    UpdateEnabledTags();
+}
+
+void GlowEffect::SetDualFilterLevels(unsigned levels)
+{
+    levels = Clamp(levels, 1u, MAX_GLOW_LEVELS);
+
+    if (levels != dualLevels_)
+    {
+        dualLevels_ = levels;
+        BuildDualFilterChain();
+        UpdateEnabledTags();
+    }
+}
+
+void GlowEffect::SetTargetFormat(unsigned format)
+{
+    targetFormat_ = format;
+
+    if (!renderPath_)
+    {
+        return;
+    }
+
+    // the view picks up the new format when it allocates its screen buffers next frame
+    for ( unsigned i = 0; i < renderPath_->renderTargets_.Size(); ++i )
+    {
+        RenderTargetInfo &info = renderPath_->renderTargets_[i];
+
+        if (info.tag_.StartsWith(GLOW_TAG) && info.name_ != GLOW_DEPTH_NAME)
+        {
+            info.format_ = format;
+        }
+    }
+}
+
+unsigned GlowEffect::AppendMemoryReport(String &report) const
+{
+    unsigned totalBytes = 0;
+
+    if (!renderPath_)
+    {
+        return totalBytes;
+    }
+
+    IntVector2 viewSize = GetViewSize();
+
+    for ( unsigned i = 0; i < renderPath_->renderTargets_.Size(); ++i )
+    {
+        const RenderTargetInfo &info = renderPath_->renderTargets_[i];
+
+        if (!info.tag_.StartsWith(GLOW_TAG) || !info.enabled_)
+        {
+            continue;
+        }
+
+        Vector2 size = GetTargetSize(info.name_, viewSize);
+        unsigned bytes = (unsigned)(size.x_ * size.y_) * RenderTargetFormat::GetBytesPerPixel(info.format_);
+        report.AppendWithFormat("  %s %dx%d  format 0x%x  %u bytes\n", info.name_.CString(), (int)size.x_, (int)size.y_,
+                                info.format_, bytes);
+        totalBytes += bytes;
+    }
+
+    return totalBytes;
+}
+
+void GlowEffect::UpdateEnabledTags()
+{
+    if (!renderPath_)
+    {
+        return;
+    }
+
+    bool active = IsActive();
+
+    renderPath_->SetEnabled(GLOW_TAG, active);
+    renderPath_->SetEnabled(GLOW_GAUSSIAN_TAG, active && blurMode_ == GlowBlur_Gaussian);
+    renderPath_->SetEnabled(GLOW_DUAL_TAG, active && blurMode_ == GlowBlur_DualFilter);
+
+    // point the apply pass at the last target of the active blur
+    const String blurResult = blurMode_ == GlowBlur_Gaussian ? String("blurv") : String("glowdual0");
+
+    for ( unsigned i = 0; i < renderPath_->commands_.Size(); ++i )
+    {
+        RenderPathCommand &command = renderPath_->commands_[i];
+
+        if (command.type_ == CMD_QUAD && command.pixelShaderName_ == "ApplyGlow")
+        {
+            command.SetTextureName(TU_ENVIRONMENT, blurResult);
+        }
+    }
+
+    UpdateTexelSizes();
+}
+
+void GlowEffect::BuildDualFilterChain()
+{
+    if (!renderPath_)
+    {
+        return;
+    }
+
+    renderPath_->RemoveCommands(GLOW_DUAL_TAG);
+    renderPath_->RemoveRenderTargets(GLOW_DUAL_TAG);
+
+    // chain goes in right before the apply pass
+    unsigned insertIdx = renderPath_->commands_.Size();
+
+    for ( unsigned i = 0; i < renderPath_->commands_.Size(); ++i )
+    {
+        if (renderPath_->commands_[i].pixelShaderName_ == "ApplyGlow")
+        {
+            insertIdx = i;
+            break;
+        }
+    }
+
+    for ( unsigned i = 0; i < dualLevels_; ++i )
+    {
+        RenderTargetInfo target;
+        target.name_ = "glowdual" + String(i);
+        target.tag_ = GLOW_DUAL_TAG;
+        target.format_ = targetFormat_;
+        target.sizeMode_ = SIZE_VIEWPORTDIVISOR;
+        target.size_ = Vector2((float)(2 << i), (float)(2 << i));
+        target.filtered_ = true;
+        renderPath_->AddRenderTarget(target);
+    }
+
+    // quads only cover the glow rect, clear so taps outside of it read black
+    RenderPathCommand clear;
+    clear.type_ = CMD_CLEAR;
+    clear.tag_ = GLOW_DUAL_TAG;
+    clear.clearFlags_ = CLEAR_COLOR;
+    clear.clearColor_ = Color::TRANSPARENT;
+
+    for ( unsigned i = 0; i < dualLevels_; ++i )
+    {
+        clear.SetOutput(0, "glowdual" + String(i));
+        renderPath_->InsertCommand(insertIdx++, clear);
+    }
+
+    RenderPathCommand command;
+    command.type_ = CMD_QUAD;
+    command.tag_ = GLOW_DUAL_TAG;
+    command.vertexShaderName_ = "DualFilter";
+    command.pixelShaderName_ = "DualFilter";
+    command.SetShaderParameter("DualOffset", 1.0f);
+    command.SetShaderParameter("GlowRect", Vector4(glowRect_.min_.x_, glowRect_.min_.y_, glowRect_.max_.x_, glowRect_.max_.y_));
+
+    // downsample glowmask -> glowdual0 -> ... -> glowdualN-1
+    command.pixelShaderDefines_ = "DOWNSAMPLE";
+
+    for ( unsigned i = 0; i < dualLevels_; ++i )
+    {
+        command.SetTextureName(TU_DIFFUSE, i == 0 ? String("glowmask") : "glowdual" + String(i - 1));
+        command.SetOutput(0, "glowdual" + String(i));
+        renderPath_->InsertCommand(insertIdx++, command);
+    }
+
+    // upsample back up to glowdual0, the blur radius grows with each level
+    command.pixelShaderDefines_ = "UPSAMPLE";
+
+    for ( int i = (int)dualLevels_ - 1; i > 0; --i )
+    {
+        command.SetTextureName(TU_DIFFUSE, "glowdual" + String(i));
+        command.SetOutput(0, "glowdual" + String(i - 1));
+        renderPath_->InsertCommand(insertIdx++, command);
+    }
+}
+
+IntVector2 GlowEffect::GetViewSize() const
+{
+    Graphics* graphics = GetSubsystem<Graphics>();
+    const IntRect &rect = viewport_ ? viewport_->GetRect() : IntRect::ZERO;
+
+    if (rect == IntRect::ZERO)
+    {
+        return IntVector2(graphics->GetWidth(), graphics->GetHeight());
+    }
+
+    return IntVector2(rect.Width(), rect.Height());
+}
+
+Vector2 GlowEffect::GetTargetSize(const String &name, const IntVector2 &viewSize) const
+{
+    for ( unsigned i = 0; i < renderPath_->renderTargets_.Size(); ++i )
+    {
+        const RenderTargetInfo &info = renderPath_->renderTargets_[i];
+
+        if (info.name_.Compare(name, false) != 0)
+        {
+            continue;
+        }
+
+        // same rounding as View::AllocateScreenBuffers
+        switch (info.sizeMode_)
+        {
+        case SIZE_VIEWPORTDIVISOR:
+            return Vector2((float)Max((int)((float)viewSize.x_ / info.size_.x_ + 0.5f), 1),
+                           (float)Max((int)((float)viewSize.y_ / info.size_.y_ + 0.5f), 1));
+
+        case SIZE_VIEWPORTMULTIPLIER:
+            return Vector2((float)Max((int)((float)viewSize.x_ * info.size_.x_ + 0.5f), 1),
+                           (float)Max((int)((float)viewSize.y_ * info.size_.y_ + 0.5f), 1));
+
+        default:
+            return info.size_;
+        }
+    }
+
+    // viewport or unknown target
+    return Vector2((float)viewSize.x_, (float)viewSize.y_);
+}
+
+void GlowEffect::UpdateTexelSizes()
+{
+    if (!renderPath_)
+    {
+        return;
+    }
+
+    IntVector2 viewSize = GetViewSize();
+    lastViewSize_ = viewSize;
+    blurRadius_ = 0.0f;
+    blurPixels_ = 0;
+    blurFetches_ = 0;
+
+    for ( unsigned i = 0; i < renderPath_->commands_.Size(); ++i )
+    {
+        RenderPathCommand &command = renderPath_->commands_[i];
+
+        if (command.type_ != CMD_QUAD)
+        {
+            continue;
+        }
+
+        float spread = 0.0f;
+
+        if (command.pixelShaderName_ == "GlowBlur")
+        {
+            // blur taps step in texels of the target being written
+            Vector2 size = GetTargetSize(command.GetOutputName(0), viewSize);
+            command.SetShaderParameter("BlurHInvSize", Vector2(1.0f / size.x_, 1.0f / size.y_));
+
+            unsigned halfKernel = GetFetchesPerPixel(command) / 2;
+            spread = halfKernel * command.GetShaderParameter("BlurRadius").GetFloat() * viewSize.x_ / size.x_;
+        }
+        else if (command.pixelShaderName_ == "DualFilter")
+        {
+            // dual filter taps are offset in texels of the target being read
+            Vector2 size = GetTargetSize(command.GetTextureName(TU_DIFFUSE), viewSize);
+            command.SetShaderParameter("DualInvSize", Vector2(1.0f / size.x_, 1.0f / size.y_));
+
+            // outermost taps plus the bilinear footprint, about two source texels
+            spread = 2.0f * viewSize.x_ / size.x_;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (command.enabled_)
+        {
+            blurRadius_ += spread;
+
+            Vector2 outSize = GetTargetSize(command.GetOutputName(0), viewSize);
+            unsigned pixels = (unsigned)(outSize.x_ * outSize.y_);
+            blurPixels_ += pixels;
+            blurFetches_ += pixels * GetFetchesPerPixel(command);
+        }
+    }
+}
+
+float GlowEffect::GetGlowCoverage() const
+{
+    return Clamp(glowRect_.Size().x_ * glowRect_.Size().y_ * 0.25f, 0.0f, 1.0f);
+}
+
+void GlowEffect::SetGlowRect(const Rect &rect)
+{
+    glowRect_ = rect;
+
+    if (!renderPath_)
+    {
+        return;
+    }
+
+    Vector4 rectParam(rect.min_.x_, rect.min_.y_, rect.max_.x_, rect.max_.y_);
+
+    for ( unsigned i = 0; i < renderPath_->commands_.Size(); ++i )
+    {
+        RenderPathCommand &command = renderPath_->commands_[i];
+
+        if (command.type_ == CMD_QUAD && command.tag_.StartsWith(GLOW_TAG))
+        {
+            command.SetShaderParameter("GlowRect", rectParam);
+        }
+    }
+}
+
+unsigned GlowEffect::GetFetchesPerPixel(const RenderPathCommand &command) const
+{
+    const String &defines = command.pixelShaderDefines_;
+
+    if (defines.Contains("DOWNSAMPLE"))
+        return 5;
+    if (defines.Contains("UPSAMPLE"))
+        return 8;
+    if (defines.Contains("BLUR9"))
+        return 9;
+    if (defines.Contains("BLUR7"))
+        return 7;
+    if (defines.Contains("BLUR5"))
+        return 5;
+    if (defines.Contains("BLUR3"))
+        return 3;
+
+    return 1;
+}
+
+void GlowEffect::HandleScreenMode(StringHash eventType, VariantMap& eventData)
+{
+    if (GetViewSize() != lastViewSize_)
+    {
+        UpdateTexelSizes();
+    }
+}
+
+bool GlowEffect::GetGlowBounds(View *view, Rect &bounds) const
+{
+    static const unsigned glowPassIdx = Technique::GetPassIndex("glowmask");
+
+    Camera *camera = view->GetCamera();
+    const Matrix3x4 &viewMatrix = camera->GetView();
+    const Matrix4 &projection = camera->GetProjection();
+    const PODVector<Drawable*> &geometries = view->GetGeometries();
+    bool found = false;
+
+    for ( unsigned i = 0; i < geometries.Size(); ++i )
+    {
+        const Vector<SourceBatch> &batches = geometries[i]->GetBatches();
+        bool glows = false;
+
+        for ( unsigned j = 0; j < batches.Size() && !glows; ++j )
+        {
+            Material *material = batches[j].material_;
+
+            if (!material)
+            {
+                continue;
+            }
+
+            for ( unsigned k = 0; k < material->GetNumTechniques(); ++k )
+            {
+                Technique *technique = material->GetTechnique(k);
+
+                if (technique && technique->HasPass(glowPassIdx))
+                {
+                    glows = true;
+                    break;
+                }
+            }
+        }
+
+        if (!glows)
+        {
+            continue;
+        }
+
+        // same projection as the view's light scissor, near clipped boxes are handled by Projected()
+        Rect rect = geometries[i]->GetWorldBoundingBox().Transformed(viewMatrix).Projected(projection);
+
+        if (!found)
+        {
+            bounds = rect;
+            found = true;
+        }
+        else
+        {
+            bounds.Merge(rect);
+        }
+    }
+
+    return found;
+}
+
+void GlowEffect::HandleEndViewUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace EndViewUpdate;
+
+    if (!enabled_ || !viewport_ || eventData[P_CAMERA].GetPtr() != viewport_->GetCamera())
+    {
+        return;
+    }
+
+    Rect bounds;
+    bool visible = GetGlowBounds(static_cast<View*>(eventData[P_VIEW].GetPtr()), bounds);
+
+    if (visible)
+    {
+        // expand by the blur spread, converted to ndc
+        IntVector2 viewSize = GetViewSize();
+        Vector2 expand(blurRadius_ * 2.0f / viewSize.x_, blurRadius_ * 2.0f / viewSize.y_);
+
+        bounds.min_.x_ = Max(bounds.min_.x_ - expand.x_, -1.0f);
+        bounds.min_.y_ = Max(bounds.min_.y_ - expand.y_, -1.0f);
+        bounds.max_.x_ = Min(bounds.max_.x_ + expand.x_, 1.0f);
+        bounds.max_.y_ = Min(bounds.max_.y_ + expand.y_, 1.0f);
+        SetGlowRect(bounds);
+    }
+
+    if (!skipWhenIdle_)
+    {
+        return;
+    }
+
+    // the view has culled by now, disabling takes effect for this frame's render. The view only
+    // collects glowmask batches for enabled commands, so turning back on lags a frame
+    if (visible != glowVisible_)
+    {
+        glowVisible_ = visible;
+        UpdateEnabledTags();
+    }
+}
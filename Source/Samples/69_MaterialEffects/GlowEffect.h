@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class RenderPath;
+struct RenderPathCommand;
+class View;
+class Viewport;
+class XMLFile;
+}
+
+//=============================================================================
+//=============================================================================
+enum GlowBlurMode
+{
+    GlowBlur_Gaussian,      // separable passes from Glow.xml at 1/4 size
+    GlowBlur_DualFilter,    // progressive down/upsample chain, radius grows with levels
+};
+
+static const unsigned MAX_GLOW_LEVELS = 6;
+
+//=============================================================================
+// owns the Glow commands of a viewport's render path, blur texel sizes are
+// derived from the glow render targets and refreshed on screen mode changes
+//=============================================================================
+class GlowEffect : public Object
+{
+    URHO3D_OBJECT(GlowEffect, Object);
+
+public:
+    GlowEffect(Context *context);
+    virtual ~GlowEffect(){}
+
+    /// Append the glow render path to the viewport's render path.
+    bool Init(Viewport *viewport, XMLFile *glowRenderPath);
+
+    void SetEnabled(bool enable);
+    bool IsEnabled() const { return enabled_; }
+    /// Skip the glow commands on frames where no drawable with a glowmask pass is in view, on by default.
+    void SetSkipWhenIdle(bool skip);
+    bool GetSkipWhenIdle() const { return skipWhenIdle_; }
+    /// Whether the glow commands run for the current main view.
+    bool IsActive() const { return enabled_ && (glowVisible_ || !skipWhenIdle_); }
+
+    void SetBlurMode(GlowBlurMode mode);
+    GlowBlurMode GetBlurMode() const { return blurMode_; }
+    /// Number of dual filter downsample levels, the first level is 1/2 of the viewport.
+    void SetDualFilterLevels(unsigned levels);
+    unsigned GetDualFilterLevels() const { return dualLevels_; }
+
+    /// Native format of the glow mask and blur targets, rgba by default.
+    void SetTargetFormat(unsigned format);
+    unsigned GetTargetFormat() const { return targetFormat_; }
+    /// Append one line per enabled glow target with its size, format and color bytes.
+    unsigned AppendMemoryReport(String &report) const;
+
+    /// Recompute per-command texel sizes, done automatically on screen mode change.
+    void UpdateTexelSizes();
+
+    /// Screen rect in ndc the blur and apply quads are restricted to, and its share of the screen.
+    const Rect& GetGlowRect() const { return glowRect_; }
+    float GetGlowCoverage() const;
+    /// Blur spread of the active mode in viewport pixels, the glow rect is expanded by this.
+    float GetBlurRadius() const { return blurRadius_; }
+
+    /// Estimated blur cost of the active mode: pixels written and texture fetches per frame.
+    unsigned GetBlurPixels() const { return (unsigned)(blurPixels_ * GetGlowCoverage()); }
+    unsigned GetBlurFetches() const { return (unsigned)(blurFetches_ * GetGlowCoverage()); }
+
+protected:
+    void BuildDualFilterChain();
+    void UpdateEnabledTags();
+    IntVector2 GetViewSize() const;
+    Vector2 GetTargetSize(const String &name, const IntVector2 &viewSize) const;
+    unsigned GetFetchesPerPixel(const RenderPathCommand &command) const;
+
+    bool GetGlowBounds(View *view, Rect &bounds) const;
+    void SetGlowRect(const Rect &rect);
+
+    void HandleScreenMode(StringHash eventType, VariantMap& eventData);
+    void HandleEndViewUpdate(StringHash eventType, VariantMap& eventData);
+
+protected:
+    WeakPtr<Viewport>     viewport_;
+    SharedPtr<RenderPath> renderPath_;
+    IntVector2            lastViewSize_;
+    GlowBlurMode          blurMode_;
+    unsigned              dualLevels_;
+    unsigned              targetFormat_;
+    bool                  enabled_;
+    bool                  skipWhenIdle_;
+    bool                  glowVisible_;
+
+    // screen restriction
+    Rect                  glowRect_;
+    float                 blurRadius_;
+
+    // cost estimate of the enabled blur commands at full screen
+    unsigned              blurPixels_;
+    unsigned              blurFetches_;
+};
@@ -0,0 +1,189 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include "HandleCache.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+HandleCache::HandleCache(Context *context)
+    : Object(context)
+    , numMisses_(0)
+{
+}
+
+void HandleCache::SetScene(Scene *scene)
+{
+    if (scene_)
+    {
+        UnsubscribeFromAllEvents();
+    }
+
+    scene_ = scene;
+    Clear();
+
+    if (scene_)
+    {
+        SubscribeToEvent(scene_, E_NODEADDED, URHO3D_HANDLER(HandleCache, HandleNodeAdded));
+        SubscribeToEvent(scene_, E_NODEREMOVED, URHO3D_HANDLER(HandleCache, HandleNodeRemoved));
+        SubscribeToEvent(scene_, E_NODENAMECHANGED, URHO3D_HANDLER(HandleCache, HandleNodeNameChanged));
+        SubscribeToEvent(scene_, E_COMPONENTADDED, URHO3D_HANDLER(HandleCache, HandleComponentChanged));
+        SubscribeToEvent(scene_, E_COMPONENTREMOVED, URHO3D_HANDLER(HandleCache, HandleComponentChanged));
+    }
+}
+
+void HandleCache::Clear()
+{
+    entries_.Clear();
+}
+
+HandleCache::CacheEntry& HandleCache::GetEntry(StringHash nameHash)
+{
+    HashMap<StringHash, CacheEntry>::Iterator itr = entries_.Find(nameHash);
+
+    if (itr == entries_.End())
+    {
+        // miss, the only place the scene tree gets searched
+        ++numMisses_;
+        itr = entries_.Insert(MakePair(nameHash, CacheEntry()));
+
+        if (scene_)
+        {
+            itr->second_.node_ = scene_->GetChild(nameHash, true);
+        }
+    }
+
+    return itr->second_;
+}
+
+Node* HandleCache::GetNode(StringHash nameHash)
+{
+    return GetEntry(nameHash).node_;
+}
+
+Component* HandleCache::GetComponent(StringHash nodeNameHash, StringHash type)
+{
+    CacheEntry &entry = GetEntry(nodeNameHash);
+
+    if (!entry.node_)
+    {
+        return NULL;
+    }
+
+    HashMap<StringHash, WeakPtr<Component> >::Iterator itr = entry.components_.Find(type);
+
+    if (itr == entry.components_.End())
+    {
+        ++numMisses_;
+        itr = entry.components_.Insert(MakePair(type, WeakPtr<Component>(entry.node_->GetComponent(type))));
+    }
+
+    return itr->second_;
+}
+
+void HandleCache::RemoveNodeEntries(Node *node, bool includeChildren)
+{
+    for (HashMap<StringHash, CacheEntry>::Iterator itr = entries_.Begin(); itr != entries_.End();)
+    {
+        Node *cached = itr->second_.node_;
+
+        if (cached && (cached == node || (includeChildren && cached->IsChildOf(node))))
+        {
+            itr = entries_.Erase(itr);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+}
+
+void HandleCache::RemoveNullEntries()
+{
+    for (HashMap<StringHash, CacheEntry>::Iterator itr = entries_.Begin(); itr != entries_.End();)
+    {
+        if (!itr->second_.node_)
+        {
+            itr = entries_.Erase(itr);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+}
+
+void HandleCache::HandleNodeAdded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace NodeAdded;
+
+    // a new node (or a child in its subtree) may now satisfy a previously failed lookup
+    Node *node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+    if (node)
+    {
+        entries_.Erase(node->GetNameHash());
+    }
+    RemoveNullEntries();
+}
+
+void HandleCache::HandleNodeRemoved(StringHash eventType, VariantMap& eventData)
+{
+    using namespace NodeRemoved;
+
+    Node *node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+    if (node)
+    {
+        RemoveNodeEntries(node, true);
+    }
+}
+
+void HandleCache::HandleNodeNameChanged(StringHash eventType, VariantMap& eventData)
+{
+    using namespace NodeNameChanged;
+
+    Node *node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+    if (node)
+    {
+        RemoveNodeEntries(node, false);
+        entries_.Erase(node->GetNameHash());
+    }
+    RemoveNullEntries();
+}
+
+void HandleCache::HandleComponentChanged(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ComponentAdded;
+
+    Node *node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+
+    for (HashMap<StringHash, CacheEntry>::Iterator itr = entries_.Begin(); itr != entries_.End(); ++itr)
+    {
+        if (itr->second_.node_.Get() == node)
+        {
+            itr->second_.components_.Clear();
+        }
+    }
+}
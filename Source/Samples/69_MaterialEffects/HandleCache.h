@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Scene/Node.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class Scene;
+}
+
+//=============================================================================
+// caches node-by-name and component-by-type lookups, entries are dropped
+// when the scene reports a change that could make them stale
+//=============================================================================
+class HandleCache : public Object
+{
+    URHO3D_OBJECT(HandleCache, Object);
+
+public:
+    HandleCache(Context *context);
+    virtual ~HandleCache(){}
+
+    void SetScene(Scene *scene);
+    void Clear();
+
+    /// Return a recursively searched child of the scene by name hash, NULL results are cached too.
+    Node* GetNode(StringHash nameHash);
+    Component* GetComponent(StringHash nodeNameHash, StringHash type);
+
+    template <class T> T* GetComponent(StringHash nodeNameHash)
+    {
+        return static_cast<T*>(GetComponent(nodeNameHash, T::GetTypeStatic()));
+    }
+
+    unsigned GetNumMisses() const { return numMisses_; }
+
+protected:
+    struct CacheEntry
+    {
+        WeakPtr<Node>                           node_;
+        HashMap<StringHash, WeakPtr<Component> > components_;
+    };
+
+    CacheEntry& GetEntry(StringHash nameHash);
+    void RemoveNodeEntries(Node *node, bool includeChildren);
+    void RemoveNullEntries();
+
+    void HandleNodeAdded(StringHash eventType, VariantMap& eventData);
+    void HandleNodeRemoved(StringHash eventType, VariantMap& eventData);
+    void HandleNodeNameChanged(StringHash eventType, VariantMap& eventData);
+    void HandleComponentChanged(StringHash eventType, VariantMap& eventData);
+
+protected:
+    WeakPtr<Scene>                  scene_;
+    HashMap<StringHash, CacheEntry> entries_;
+    unsigned                        numMisses_;
+};
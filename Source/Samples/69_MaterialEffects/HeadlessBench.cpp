@@ -0,0 +1,441 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Scene.h>
+#include <math.h>
+
+#include "HeadlessBench.h"
+#include "MaterialAnimator.h"
+#include "SplashHandler.h"
+#include "UVSequencer.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+static const char* sectionNames[Max_BenchSections] =
+{
+    "physics",
+    "sequencers",
+    "splashes",
+    "scene",
+    "effects",
+    "other",
+};
+
+enum ComponentTimer
+{
+    CompTimer_Sequencers,
+    CompTimer_Splashes,
+    CompTimer_Animators,
+};
+
+//=============================================================================
+//=============================================================================
+HeadlessBench::HeadlessBench(Context *context)
+    : Object(context)
+    , pathTime_(0.0)
+    , curWaypoint_(0)
+    , rippleTime_(0.0f)
+    , numRipples_(0)
+    , numFrames_(0)
+    , warmupFrames_(30)
+    , frameCount_(0)
+    , timeStep_(1.0f / 60.0f)
+    , wallUSec_(0)
+{
+    for ( unsigned i = 0; i < Max_BenchSections; ++i )
+    {
+        spanUSec_[i] = 0;
+        sections_[i].totalUSec_ = 0;
+        sections_[i].maxUSec_ = 0;
+    }
+
+    for ( unsigned i = 0; i < 3; ++i )
+    {
+        lastComponentUSec_[i] = 0;
+    }
+}
+
+HeadlessBench::~HeadlessBench()
+{
+    Finish();
+}
+
+bool HeadlessBench::Start(Scene *scene, Node *cameraNode, const String &pathFile, unsigned numFrames, float timeStep)
+{
+    if (!scene || !cameraNode || !scene->GetComponent<PhysicsWorld>())
+    {
+        return false;
+    }
+
+    scene_ = scene;
+    cameraNode_ = cameraNode;
+    numFrames_ = numFrames;
+    timeStep_ = Max(timeStep, 0.001f);
+
+    if (!LoadPath(pathFile))
+    {
+        return false;
+    }
+
+    // stepped by the bench with the fixed time step instead of the frame time
+    physicsWorld_ = scene->GetComponent<PhysicsWorld>();
+    physicsWorld_->SetUpdateEnabled(false);
+    scene->SetUpdateEnabled(false);
+
+    // nothing is in view without a renderer, keep the view dependent updates running so they are measured
+    PODVector<UVSequencer*> sequencers;
+    scene->GetComponents<UVSequencer>(sequencers, true);
+    for ( unsigned i = 0; i < sequencers.Size(); ++i )
+    {
+        sequencers[i]->SetUpdateInvisible(true);
+        sequencers_.Push(WeakPtr<UVSequencer>(sequencers[i]));
+    }
+
+    PODVector<SplashHandler*> splashHandlers;
+    scene->GetComponents<SplashHandler>(splashHandlers, true);
+    for ( unsigned i = 0; i < splashHandlers.Size(); ++i )
+    {
+        splashHandlers_.Push(WeakPtr<SplashHandler>(splashHandlers[i]));
+    }
+
+    PODVector<MaterialAnimator*> animators;
+    scene->GetComponents<MaterialAnimator>(animators, true);
+    for ( unsigned i = 0; i < animators.Size(); ++i )
+    {
+        animators[i]->SetUpdateInvisible(true);
+        animators_.Push(WeakPtr<MaterialAnimator>(animators[i]));
+    }
+
+    // scripted splashes are sent from the physics step, where the character's collision splashes come from
+    SubscribeToEvent(physicsWorld_, E_PHYSICSPRESTEP, URHO3D_HANDLER(HeadlessBench, HandlePhysicsPreStep));
+
+    frameUSec_.Reserve(numFrames_);
+    frameTimer_.Reset();
+
+    URHO3D_LOGINFOF("headless bench: %u frames + %u warm-up, %.4f s step, %u waypoints, %u sequencers",
+                    numFrames_, warmupFrames_, timeStep_, waypoints_.Size(), sequencers_.Size());
+
+    return true;
+}
+
+bool HeadlessBench::LoadPath(const String &pathFile)
+{
+    XMLFile *xmlFile = GetSubsystem<ResourceCache>()->GetResource<XMLFile>(pathFile);
+
+    if (!xmlFile)
+    {
+        return false;
+    }
+
+    pathFile_ = pathFile;
+    waypoints_.Clear();
+
+    // waypoints look at a level node from an offset, a moved node moves the path with it
+    for ( XMLElement elem = xmlFile->GetRoot().GetChild("waypoint"); elem; elem = elem.GetNext("waypoint") )
+    {
+        Waypoint waypoint;
+        waypoint.time_ = elem.GetFloat("time");
+        waypoint.target_ = elem.GetVector3("target");
+        waypoint.rippleInterval_ = elem.HasAttribute("ripple") ? elem.GetFloat("ripple") : 0.0f;
+
+        if (elem.HasAttribute("node"))
+        {
+            Node *node = scene_->GetChild(elem.GetAttribute("node"), true);
+
+            if (!node)
+            {
+                URHO3D_LOGERROR("headless bench: path node not found " + elem.GetAttribute("node"));
+                return false;
+            }
+
+            waypoint.target_ += node->GetWorldPosition();
+        }
+
+        waypoint.position_ = waypoint.target_ + elem.GetVector3("offset");
+
+        if (waypoints_.Size() && waypoint.time_ <= waypoints_.Back().time_)
+        {
+            URHO3D_LOGERROR("headless bench: waypoint times must increase in " + pathFile);
+            return false;
+        }
+
+        waypoints_.Push(waypoint);
+    }
+
+    return waypoints_.Size() >= 2;
+}
+
+void HeadlessBench::UpdateCamera()
+{
+    // loops, the last waypoint is the end of the path
+    const float duration = waypoints_.Back().time_ - waypoints_[0].time_;
+    float time = waypoints_[0].time_ + (float)fmod(pathTime_, (double)duration);
+
+    while (curWaypoint_ + 2 < waypoints_.Size() && time >= waypoints_[curWaypoint_ + 1].time_)
+    {
+        ++curWaypoint_;
+    }
+    while (curWaypoint_ > 0 && time < waypoints_[curWaypoint_].time_)
+    {
+        --curWaypoint_;
+    }
+
+    const Waypoint &from = waypoints_[curWaypoint_];
+    const Waypoint &to = waypoints_[curWaypoint_ + 1];
+
+    // eased per segment, the camera slows down at each waypoint
+    float t = Clamp((time - from.time_) / (to.time_ - from.time_), 0.0f, 1.0f);
+    t = SmoothStep(0.0f, 1.0f, t);
+
+    cameraNode_->SetWorldPosition(from.position_.Lerp(to.position_, t));
+    cameraNode_->LookAt(from.target_.Lerp(to.target_, t));
+}
+
+void HeadlessBench::StepScene()
+{
+    if (!scene_ || !physicsWorld_ || !cameraNode_)
+    {
+        return;
+    }
+
+    UpdateCamera();
+
+    BeginSection(BenchSection_Physics);
+    physicsWorld_->Update(timeStep_);
+    EndSection(BenchSection_Physics);
+
+    BeginSection(BenchSection_Scene);
+    scene_->Update(timeStep_);
+    EndSection(BenchSection_Scene);
+
+    pathTime_ += (double)timeStep_;
+}
+
+void HeadlessBench::BeginSection(BenchSection section)
+{
+    sectionTimers_[section].Reset();
+}
+
+void HeadlessBench::EndSection(BenchSection section)
+{
+    spanUSec_[section] += sectionTimers_[section].GetUSec(false);
+}
+
+void HeadlessBench::GetComponentUSec(long long *usec) const
+{
+    usec[CompTimer_Sequencers] = 0;
+    usec[CompTimer_Splashes] = 0;
+    usec[CompTimer_Animators] = 0;
+
+    for ( unsigned i = 0; i < sequencers_.Size(); ++i )
+    {
+        if (sequencers_[i])
+            usec[CompTimer_Sequencers] += sequencers_[i]->GetUpdateUSec();
+    }
+    for ( unsigned i = 0; i < splashHandlers_.Size(); ++i )
+    {
+        if (splashHandlers_[i])
+            usec[CompTimer_Splashes] += splashHandlers_[i]->GetUpdateUSec();
+    }
+    for ( unsigned i = 0; i < animators_.Size(); ++i )
+    {
+        if (animators_[i])
+            usec[CompTimer_Animators] += animators_[i]->GetUpdateUSec();
+    }
+}
+
+void HeadlessBench::EndFrame()
+{
+    if (IsFinished())
+    {
+        return;
+    }
+
+    long long frameUSec = frameTimer_.GetUSec(true);
+
+    // the components time themselves, split them out of the spans they run in
+    long long componentUSec[3];
+    GetComponentUSec(componentUSec);
+
+    long long seqUSec = componentUSec[CompTimer_Sequencers] - lastComponentUSec_[CompTimer_Sequencers];
+    long long splashUSec = componentUSec[CompTimer_Splashes] - lastComponentUSec_[CompTimer_Splashes];
+    long long animUSec = componentUSec[CompTimer_Animators] - lastComponentUSec_[CompTimer_Animators];
+
+    for ( unsigned i = 0; i < 3; ++i )
+    {
+        lastComponentUSec_[i] = componentUSec[i];
+    }
+
+    long long frameSections[Max_BenchSections];
+    frameSections[BenchSection_Physics]    = Max(spanUSec_[BenchSection_Physics] - seqUSec - splashUSec, 0LL);
+    frameSections[BenchSection_Sequencers] = seqUSec;
+    frameSections[BenchSection_Splashes]   = splashUSec;
+    frameSections[BenchSection_Scene]      = Max(spanUSec_[BenchSection_Scene] - animUSec, 0LL);
+    frameSections[BenchSection_Effects]    = spanUSec_[BenchSection_Effects] + animUSec;
+
+    long long measuredUSec = 0;
+    for ( unsigned i = 0; i < BenchSection_Other; ++i )
+    {
+        measuredUSec += frameSections[i];
+    }
+    frameSections[BenchSection_Other] = Max(frameUSec - measuredUSec, 0LL);
+
+    for ( unsigned i = 0; i < Max_BenchSections; ++i )
+    {
+        spanUSec_[i] = 0;
+    }
+
+    if (++frameCount_ <= warmupFrames_)
+    {
+        wallTimer_.Reset();
+        return;
+    }
+
+    for ( unsigned i = 0; i < Max_BenchSections; ++i )
+    {
+        sections_[i].totalUSec_ += frameSections[i];
+        sections_[i].maxUSec_ = Max(sections_[i].maxUSec_, frameSections[i]);
+    }
+    frameUSec_.Push(frameUSec);
+
+    if (IsFinished())
+    {
+        wallUSec_ = wallTimer_.GetUSec(false);
+        Finish();
+    }
+}
+
+void HeadlessBench::Finish()
+{
+    UnsubscribeFromAllEvents();
+
+    // hand the updates back
+    if (physicsWorld_)
+    {
+        physicsWorld_->SetUpdateEnabled(true);
+    }
+    if (scene_)
+    {
+        scene_->SetUpdateEnabled(true);
+    }
+}
+
+bool HeadlessBench::SaveJSON(const String &fileName)
+{
+    JSONFile json(context_);
+    JSONValue& root = json.GetRoot();
+    const unsigned numMeasured = frameUSec_.Size();
+
+    root.Set("path", pathFile_);
+    root.Set("frames", numMeasured);
+    root.Set("warmupFrames", warmupFrames_);
+    root.Set("timeStep", timeStep_);
+    root.Set("simulatedSec", (double)numMeasured * (double)timeStep_);
+    root.Set("wallMs", (double)wallUSec_ / 1000.0);
+    root.Set("ripples", numRipples_);
+    root.Set("sequencers", sequencers_.Size());
+
+    if (numMeasured)
+    {
+        PODVector<long long> sorted = frameUSec_;
+        Sort(sorted.Begin(), sorted.End());
+
+        long long totalUSec = 0;
+        for ( unsigned i = 0; i < numMeasured; ++i )
+        {
+            totalUSec += sorted[i];
+        }
+
+        JSONValue frame;
+        frame.Set("avgMs", (double)totalUSec / (double)numMeasured / 1000.0);
+        frame.Set("minMs", (double)sorted[0] / 1000.0);
+        frame.Set("medianMs", (double)sorted[numMeasured / 2] / 1000.0);
+        frame.Set("p95Ms", (double)sorted[Min(numMeasured * 95 / 100, numMeasured - 1)] / 1000.0);
+        frame.Set("maxMs", (double)sorted[numMeasured - 1] / 1000.0);
+        root.Set("frame", frame);
+
+        // per frame averages and worst frame of each section, the sections add up to the frame
+        JSONValue sections;
+        for ( unsigned i = 0; i < Max_BenchSections; ++i )
+        {
+            JSONValue entry;
+            entry.Set("totalMs", (double)sections_[i].totalUSec_ / 1000.0);
+            entry.Set("avgMs", (double)sections_[i].totalUSec_ / (double)numMeasured / 1000.0);
+            entry.Set("maxMs", (double)sections_[i].maxUSec_ / 1000.0);
+            sections.Set(sectionNames[i], entry);
+        }
+        root.Set("sections", sections);
+    }
+
+    File file(context_, fileName, FILE_WRITE);
+    if (!file.IsOpen() || !json.Save(file, "    "))
+    {
+        URHO3D_LOGERROR("headless bench: failed to write " + fileName);
+        return false;
+    }
+
+    URHO3D_LOGINFO("headless bench: timings written to " + fileName);
+    return true;
+}
+
+void HeadlessBench::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+
+    const Waypoint &waypoint = waypoints_[curWaypoint_];
+
+    if (waypoint.rippleInterval_ <= 0.0f)
+    {
+        rippleTime_ = 0.0f;
+        return;
+    }
+
+    rippleTime_ += eventData[P_TIMESTEP].GetFloat();
+
+    if (rippleTime_ >= waypoint.rippleInterval_)
+    {
+        rippleTime_ -= waypoint.rippleInterval_;
+
+        // spread over the water in front of the waypoint target, the same sequence every run
+        float angle = (float)numRipples_ * 137.5f;
+        float radius = 0.5f + (float)(numRipples_ % 5) * 0.6f;
+
+        VariantMap& splashData = GetEventDataMap();
+        splashData[SplashEvent::P_POS] = waypoint.target_ + Vector3(Cos(angle) * radius, 0.0f, Sin(angle) * radius);
+        splashData[SplashEvent::P_DIR] = Vector3::DOWN;
+        splashData[SplashEvent::P_SPL1] = Splash_Ripple;
+        SendEvent(E_SPLASH, splashData);
+
+        ++numRipples_;
+    }
+}
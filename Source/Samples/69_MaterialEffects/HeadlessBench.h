@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class Node;
+class PhysicsWorld;
+class Scene;
+}
+
+class MaterialAnimator;
+class SplashHandler;
+class UVSequencer;
+
+//=============================================================================
+//=============================================================================
+enum BenchSection
+{
+    BenchSection_Physics,       // physics step and fixed logic, without sequencers and splashes
+    BenchSection_Sequencers,
+    BenchSection_Splashes,
+    BenchSection_Scene,         // scene update without the material animators
+    BenchSection_Effects,       // material animators and the demo's effect updates
+    BenchSection_Other,         // rest of the engine frame
+    Max_BenchSections
+};
+
+//=============================================================================
+// headless benchmark, steps physics and the scene by a fixed time step,
+// moves the camera along a scripted path and records cpu time per section,
+// the results are written as json
+//=============================================================================
+class HeadlessBench : public Object
+{
+    URHO3D_OBJECT(HeadlessBench, Object);
+
+public:
+    HeadlessBench(Context *context);
+    virtual ~HeadlessBench();
+
+    /// Take over the scene and physics updates and load the camera path.
+    bool Start(Scene *scene, Node *cameraNode, const String &pathFile, unsigned numFrames, float timeStep);
+    /// Frames run before measuring, delayed starts and first use allocations land there.
+    void SetWarmupFrames(unsigned warmupFrames) { warmupFrames_ = warmupFrames; }
+
+    /// Move the camera and advance physics and the scene by one fixed step.
+    void StepScene();
+    void BeginSection(BenchSection section);
+    void EndSection(BenchSection section);
+    /// Call once per engine frame after all measured work.
+    void EndFrame();
+
+    bool IsFinished() const { return frameCount_ >= warmupFrames_ + numFrames_; }
+    float GetTimeStep() const { return timeStep_; }
+    bool SaveJSON(const String &fileName);
+
+protected:
+    bool LoadPath(const String &pathFile);
+    void UpdateCamera();
+    void GetComponentUSec(long long *usec) const;
+    void Finish();
+
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+
+protected:
+    struct Waypoint
+    {
+        float   time_;
+        Vector3 position_;
+        Vector3 target_;
+        float   rippleInterval_;
+    };
+
+    struct SectionStats
+    {
+        long long totalUSec_;
+        long long maxUSec_;
+    };
+
+    WeakPtr<Scene>                    scene_;
+    WeakPtr<PhysicsWorld>             physicsWorld_;
+    WeakPtr<Node>                     cameraNode_;
+    String                            pathFile_;
+
+    // camera path
+    PODVector<Waypoint>               waypoints_;
+    double                            pathTime_;
+    unsigned                          curWaypoint_;
+    float                             rippleTime_;
+    unsigned                          numRipples_;
+
+    // components that time their own updates
+    Vector<WeakPtr<UVSequencer> >     sequencers_;
+    Vector<WeakPtr<SplashHandler> >   splashHandlers_;
+    Vector<WeakPtr<MaterialAnimator> > animators_;
+    long long                         lastComponentUSec_[3];
+
+    unsigned                          numFrames_;
+    unsigned                          warmupFrames_;
+    unsigned                          frameCount_;
+    float                             timeStep_;
+
+    // timing
+    HiresTimer                        sectionTimers_[Max_BenchSections];
+    long long                         spanUSec_[Max_BenchSections];
+    SectionStats                      sections_[Max_BenchSections];
+    HiresTimer                        frameTimer_;
+    HiresTimer                        wallTimer_;
+    PODVector<long long>              frameUSec_;
+    long long                         wallUSec_;
+};
@@ -0,0 +1,220 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/BillboardSet.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Node.h>
+
+#include "HullBillboard.h"
+#include "UVSequencer.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+void HullBillboard::RegisterObject(Context* context)
+{
+    context->RegisterFactory<HullBillboard>();
+}
+
+HullBillboard::HullBillboard(Context* context)
+    : LogicComponent(context)
+    , faceCameraMode_(FC_ROTATE_XYZ)
+    , curCell_(-1)
+{
+    SetUpdateEventMask(0);
+}
+
+bool HullBillboard::LoadHulls(const String &hullFile, Vector<PODVector<Vector2> > &cellHulls, PODVector<Vector2> &unionHull)
+{
+    XMLFile *xmlFile = GetSubsystem<ResourceCache>()->GetResource<XMLFile>(hullFile);
+
+    if (!xmlFile)
+    {
+        return false;
+    }
+
+    XMLElement root = xmlFile->GetRoot("hulls");
+    XMLElement unionElem = root.GetChild("union");
+
+    for ( XMLElement vertElem = unionElem.GetChild("vertex"); vertElem; vertElem = vertElem.GetNext("vertex") )
+    {
+        unionHull.Push(vertElem.GetVector2("uv"));
+    }
+
+    for ( XMLElement cellElem = root.GetChild("cell"); cellElem; cellElem = cellElem.GetNext("cell") )
+    {
+        unsigned index = cellElem.GetUInt("index");
+
+        if (index >= cellHulls.Size())
+        {
+            cellHulls.Resize(index + 1);
+        }
+
+        for ( XMLElement vertElem = cellElem.GetChild("vertex"); vertElem; vertElem = vertElem.GetNext("vertex") )
+        {
+            cellHulls[index].Push(vertElem.GetVector2("uv"));
+        }
+    }
+
+    return unionHull.Size() >= 3 && cellHulls.Size() > 0;
+}
+
+bool HullBillboard::Create(const String &hullFile, Camera *camera)
+{
+    BillboardSet *billboardSet = node_->GetComponent<BillboardSet>();
+
+    if (!billboardSet || billboardSet->GetNumBillboards() == 0)
+    {
+        return false;
+    }
+
+    Vector<PODVector<Vector2> > cellHulls;
+    PODVector<Vector2> unionHull;
+
+    if (!LoadHulls(hullFile, cellHulls, unionHull))
+    {
+        URHO3D_LOGERROR("HullBillboard: failed to load " + hullFile);
+        return false;
+    }
+
+    // the billboard corners are at +-size, scaled by the node and facing the camera. the scale is baked into
+    // the vertices so the node rotation alone can face the camera
+    Vector3 worldScale = billboardSet->IsScaled() ? node_->GetWorldScale() : Vector3::ONE;
+    Vector2 halfSize = billboardSet->GetBillboard(0)->size_ * Vector2(worldScale.x_, worldScale.y_);
+
+    // triangle fans of all cells in one buffer, the current frame's range is drawn
+    PODVector<float> vertexData;
+    BoundingBox bounds;
+    cellRanges_.Resize(cellHulls.Size());
+
+    for ( unsigned c = 0; c < cellHulls.Size(); ++c )
+    {
+        // empty cells are fully transparent, nothing to draw
+        const PODVector<Vector2> &hull = cellHulls[c];
+        unsigned numVerts = hull.Size();
+        cellRanges_[c] = IntVector2(vertexData.Size() / 5, numVerts >= 3 ? (numVerts - 2) * 3 : 0);
+
+        if (numVerts < 3)
+        {
+            continue;
+        }
+
+        // uv space is y down, clockwise in local space is front facing
+        float area = 0.0f;
+        for ( unsigned i = 0; i < numVerts; ++i )
+        {
+            const Vector2 &a = hull[i];
+            const Vector2 &b = hull[(i + 1) % numVerts];
+            area += a.x_ * -b.y_ - b.x_ * -a.y_;
+        }
+
+        for ( unsigned t = 1; t + 1 < numVerts; ++t )
+        {
+            unsigned tri[3] = { 0, area < 0.0f ? t : t + 1, area < 0.0f ? t + 1 : t };
+
+            for ( unsigned v = 0; v < 3; ++v )
+            {
+                const Vector2 &uv = hull[tri[v]];
+                Vector3 pos((uv.x_ * 2.0f - 1.0f) * halfSize.x_, (1.0f - uv.y_ * 2.0f) * halfSize.y_, 0.0f);
+
+                vertexData.Push(pos.x_);
+                vertexData.Push(pos.y_);
+                vertexData.Push(pos.z_);
+                vertexData.Push(uv.x_);
+                vertexData.Push(uv.y_);
+                bounds.Merge(pos);
+            }
+        }
+    }
+
+    if (vertexData.Empty())
+    {
+        return false;
+    }
+
+    SharedPtr<VertexBuffer> vertexBuffer(new VertexBuffer(context_));
+    vertexBuffer->SetShadowed(true);
+    vertexBuffer->SetSize(vertexData.Size() / 5, MASK_POSITION | MASK_TEXCOORD1);
+    vertexBuffer->SetData(&vertexData[0]);
+
+    SharedPtr<Geometry> geometry(new Geometry(context_));
+    geometry->SetVertexBuffer(0, vertexBuffer);
+    geometry->SetDrawRange(TRIANGLE_LIST, 0, 0, 0, cellRanges_[0].y_);
+
+    model_ = new Model(context_);
+    model_->SetNumGeometries(1);
+    model_->SetGeometry(0, 0, geometry);
+    model_->SetBoundingBox(bounds);
+
+    // replace the billboard, a uv sequencer created on the node picks up the static model
+    faceCameraMode_ = billboardSet->GetFaceCameraMode();
+    Material *material = billboardSet->GetMaterial();
+    billboardSet->Remove();
+
+    node_->SetScale(Vector3::ONE);
+    StaticModel *staticModel = node_->CreateComponent<StaticModel>();
+    staticModel->SetModel(model_);
+    staticModel->SetMaterial(material);
+    staticModel_ = staticModel;
+
+    uvSequencer_ = node_->GetComponent<UVSequencer>();
+    camera_ = camera;
+    curCell_ = 0;
+
+    SubscribeToEvent(E_BEGINVIEWUPDATE, URHO3D_HANDLER(HullBillboard, HandleBeginViewUpdate));
+
+    return true;
+}
+
+void HullBillboard::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace BeginViewUpdate;
+
+    if (!camera_ || !staticModel_ || eventData[P_CAMERA].GetPtr() != camera_)
+    {
+        return;
+    }
+
+    // face the camera before the octree update of the view
+    node_->SetWorldRotation(camera_->GetFaceCameraRotation(node_->GetWorldPosition(), node_->GetWorldRotation(),
+                                                           (FaceCameraMode)faceCameraMode_));
+
+    // select the hull of the frame the sequencer shows
+    int cell = uvSequencer_ ? uvSequencer_->GetCurrentFrame() : 0;
+
+    if (cell != curCell_ && cell >= 0 && cell < (int)cellRanges_.Size())
+    {
+        model_->GetGeometry(0, 0)->SetDrawRange(TRIANGLE_LIST, 0, 0, cellRanges_[cell].x_, cellRanges_[cell].y_);
+        curCell_ = cell;
+    }
+}
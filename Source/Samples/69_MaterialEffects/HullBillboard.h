@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Scene/LogicComponent.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class Camera;
+class Model;
+class StaticModel;
+}
+
+class UVSequencer;
+
+//=============================================================================
+// replaces a uv frame billboard with the tight convex hulls written by
+// SequenceImagePacker -hull, only the hull of the current frame is drawn
+//=============================================================================
+class HullBillboard : public LogicComponent
+{
+    URHO3D_OBJECT(HullBillboard, LogicComponent);
+
+public:
+    HullBillboard(Context* context);
+    virtual ~HullBillboard(){}
+
+    static void RegisterObject(Context* context);
+
+    /// Replace the node's billboard set, faces the camera like the billboard did.
+    bool Create(const String &hullFile, Camera *camera);
+
+    unsigned GetNumCells() const { return cellRanges_.Size(); }
+
+protected:
+    bool LoadHulls(const String &hullFile, Vector<PODVector<Vector2> > &cellHulls, PODVector<Vector2> &unionHull);
+    void HandleBeginViewUpdate(StringHash eventType, VariantMap& eventData);
+
+protected:
+    SharedPtr<Model>       model_;
+    WeakPtr<StaticModel>   staticModel_;
+    WeakPtr<UVSequencer>   uvSequencer_;
+    WeakPtr<Camera>        camera_;
+    int                    faceCameraMode_;
+
+    // vertex start, count per cell
+    PODVector<IntVector2>  cellRanges_;
+    int                    curCell_;
+};
+
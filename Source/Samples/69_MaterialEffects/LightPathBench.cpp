@@ -0,0 +1,216 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/Graphics/RenderPath.h>
+#include <Urho3D/Graphics/Viewport.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "LightPathBench.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+LightPathBench::LightPathBench(Context *context)
+    : Object(context)
+    , numLights_(0)
+    , frameCount_(0)
+    , warmupFrames_(60)
+    , measureFrames_(300)
+{
+    const char *names[] = { "forward", "prepass", "deferred" };
+    const char *files[] = { "RenderPaths/Forward.xml", "RenderPaths/Prepass.xml", "RenderPaths/Deferred.xml" };
+
+    for ( unsigned i = 0; i < 3; ++i )
+    {
+        PathStats stats;
+        stats.name_       = names[i];
+        stats.file_       = files[i];
+        stats.supported_  = false;
+        stats.frames_     = 0;
+        stats.batches_    = 0;
+        stats.primitives_ = 0;
+        stats.lights_     = 0;
+        stats.frameUSec_  = 0;
+        paths_.Push(stats);
+    }
+
+    // nothing to run until started
+    curPath_ = paths_.Size();
+}
+
+LightPathBench::~LightPathBench()
+{
+    if (lightRoot_)
+    {
+        lightRoot_->Remove();
+    }
+}
+
+bool LightPathBench::Start(Viewport *viewport, const Vector3 &center, unsigned numLights)
+{
+    if (!viewport || !viewport->GetScene() || !GetSubsystem<Graphics>())
+    {
+        return false;
+    }
+
+    viewport_ = viewport;
+    savedPath_ = viewport->GetRenderPath();
+    numLights_ = numLights;
+
+    CreateLights(center, numLights);
+
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(LightPathBench, HandleEndFrame));
+
+    return BeginPath(0);
+}
+
+void LightPathBench::CreateLights(const Vector3 &center, unsigned numLights)
+{
+    Node *root = viewport_->GetScene()->CreateChild("lightBench", LOCAL);
+    lightRoot_ = root;
+
+    // overlapping grid, every pixel near the center is touched by several lights
+    const float spacing = 2.5f;
+    int side = (int)ceilf(sqrtf((float)numLights));
+    float halfExtent = (float)(side - 1) * spacing * 0.5f;
+
+    for ( unsigned i = 0; i < numLights; ++i )
+    {
+        int x = (int)i % side;
+        int z = (int)i / side;
+
+        Node *lightNode = root->CreateChild("benchLight", LOCAL);
+        lightNode->SetWorldPosition(center + Vector3((float)x * spacing - halfExtent, 1.5f, (float)z * spacing - halfExtent));
+
+        Color color;
+        color.FromHSV((float)i / (float)numLights, 0.6f, 1.0f);
+
+        Light *light = lightNode->CreateComponent<Light>();
+        light->SetLightType(LIGHT_POINT);
+        light->SetRange(spacing * 2.0f);
+        light->SetColor(color);
+        light->SetBrightness(0.5f);
+    }
+}
+
+bool LightPathBench::BeginPath(unsigned index)
+{
+    Graphics *graphics = GetSubsystem<Graphics>();
+    ResourceCache *cache = GetSubsystem<ResourceCache>();
+
+    for ( curPath_ = index; curPath_ < paths_.Size(); ++curPath_ )
+    {
+        PathStats &stats = paths_[curPath_];
+
+        stats.supported_ = (curPath_ != 1 || graphics->GetLightPrepassSupport()) &&
+                           (curPath_ != 2 || graphics->GetDeferredSupport());
+
+        XMLFile *pathFile = stats.supported_ ? cache->GetResource<XMLFile>(stats.file_) : NULL;
+
+        if (pathFile && viewport_->SetRenderPath(pathFile))
+        {
+            frameCount_ = 0;
+            frameTimer_.Reset();
+            return true;
+        }
+
+        stats.supported_ = false;
+    }
+
+    Finish();
+    return false;
+}
+
+void LightPathBench::Finish()
+{
+    UnsubscribeFromEvent(E_ENDFRAME);
+
+    if (viewport_ && savedPath_)
+    {
+        viewport_->SetRenderPath(savedPath_);
+    }
+
+    if (lightRoot_)
+    {
+        lightRoot_->Remove();
+    }
+
+    report_.Clear();
+    report_.AppendWithFormat("light path bench, %u point lights\n", numLights_);
+
+    for ( unsigned i = 0; i < paths_.Size(); ++i )
+    {
+        const PathStats &stats = paths_[i];
+
+        if (!stats.supported_ || stats.frames_ == 0)
+        {
+            report_.AppendWithFormat("  %-8s unsupported\n", stats.name_.CString());
+            continue;
+        }
+
+        float frames = (float)stats.frames_;
+        report_.AppendWithFormat("  %-8s batches %.0f  triangles %.0f  lights %.1f  frame %.2f ms\n", stats.name_.CString(),
+                                 (float)stats.batches_ / frames, (float)stats.primitives_ / frames,
+                                 (float)stats.lights_ / frames, (float)stats.frameUSec_ / frames / 1000.0f);
+    }
+
+    URHO3D_LOGINFO(report_);
+}
+
+void LightPathBench::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    if (IsFinished())
+    {
+        return;
+    }
+
+    long long frameUSec = frameTimer_.GetUSec(true);
+
+    // skip the frames that compile the path's shaders and allocate its targets
+    if (++frameCount_ <= warmupFrames_)
+    {
+        return;
+    }
+
+    Renderer *renderer = GetSubsystem<Renderer>();
+    PathStats &stats = paths_[curPath_];
+
+    ++stats.frames_;
+    stats.batches_    += renderer->GetNumBatches();
+    stats.primitives_ += renderer->GetNumPrimitives();
+    stats.lights_     += renderer->GetNumLights(true);
+    stats.frameUSec_  += frameUSec;
+
+    if (stats.frames_ >= measureFrames_)
+    {
+        BeginPath(curPath_ + 1);
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class Node;
+class RenderPath;
+class Viewport;
+}
+
+//=============================================================================
+// adds a grid of point lights and renders the same view with the forward,
+// prepass and deferred paths in turn, logs batches and frame time per path
+//=============================================================================
+class LightPathBench : public Object
+{
+    URHO3D_OBJECT(LightPathBench, Object);
+
+public:
+    LightPathBench(Context *context);
+    virtual ~LightPathBench();
+
+    /// Create the lights around center and start with the forward path.
+    bool Start(Viewport *viewport, const Vector3 &center, unsigned numLights);
+    /// Frames skipped after a path switch and frames measured per path.
+    void SetFrames(unsigned warmupFrames, unsigned measureFrames) { warmupFrames_ = warmupFrames; measureFrames_ = measureFrames; }
+
+    bool IsFinished() const { return curPath_ >= paths_.Size(); }
+    const String& GetReport() const { return report_; }
+
+protected:
+    void CreateLights(const Vector3 &center, unsigned numLights);
+    bool BeginPath(unsigned index);
+    void Finish();
+
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+
+protected:
+    struct PathStats
+    {
+        String             name_;
+        String             file_;
+        bool               supported_;
+        unsigned           frames_;
+        unsigned long long batches_;
+        unsigned long long primitives_;
+        unsigned long long lights_;
+        long long          frameUSec_;
+    };
+
+    WeakPtr<Viewport>   viewport_;
+    SharedPtr<RenderPath> savedPath_;
+    WeakPtr<Node>       lightRoot_;
+    unsigned            numLights_;
+
+    Vector<PathStats>   paths_;
+    unsigned            curPath_;
+    unsigned            frameCount_;
+    unsigned            warmupFrames_;
+    unsigned            measureFrames_;
+    HiresTimer          frameTimer_;
+
+    String              report_;
+};
+
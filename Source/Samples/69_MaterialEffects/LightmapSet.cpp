@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#include "LightmapSet.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+// units sampled by LitSolidLightMapBlend, in cLightmapWeights xyzw order
+static const TextureUnit lightmapUnits[LightmapSet::MAX_LIGHTMAPS] =
+{
+    TU_EMISSIVE,
+    TU_ENVIRONMENT,
+    TU_SPECULAR,
+    TU_NORMAL,
+};
+
+//=============================================================================
+//=============================================================================
+LightmapSet::LightmapSet(Context *context)
+    : Object(context)
+    , weights_(1.0f, 0.0f, 0.0f, 0.0f)
+{
+}
+
+bool LightmapSet::Load(const String &pathName, const String &ext, unsigned count)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    if (count > MAX_LIGHTMAPS)
+    {
+        URHO3D_LOGWARNINGF("LightmapSet: %u lightmaps requested, only %u units available", count, MAX_LIGHTMAPS);
+        count = MAX_LIGHTMAPS;
+    }
+
+    lightmaps_.Clear();
+
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        char buf[10];
+        sprintf(buf, "%03d", i);
+
+        SharedPtr<Texture2D> texture(cache->GetResource<Texture2D>(pathName + String(buf) + ext));
+        if (!texture)
+        {
+            return false;
+        }
+
+        lightmaps_.Push(texture);
+    }
+
+    return true;
+}
+
+void LightmapSet::Apply(Material *material)
+{
+    material_ = material;
+
+    if (!material)
+    {
+        return;
+    }
+
+    for ( unsigned i = 0; i < lightmaps_.Size(); ++i )
+    {
+        material->SetTexture(lightmapUnits[i], lightmaps_[i]);
+    }
+
+    material->SetShaderParameter("LightmapWeights", weights_);
+}
+
+Texture2D* LightmapSet::GetLightmap(unsigned index) const
+{
+    return index < lightmaps_.Size() ? lightmaps_[index] : (Texture2D*)NULL;
+}
+
+void LightmapSet::SetLightmap(unsigned index)
+{
+    SetBlend(index, index, 0.0f);
+}
+
+void LightmapSet::SetBlend(unsigned from, unsigned to, float blend)
+{
+    if (from >= MAX_LIGHTMAPS || to >= MAX_LIGHTMAPS)
+    {
+        return;
+    }
+
+    Vector4 weights(Vector4::ZERO);
+    float *data = &weights.x_;
+    blend = Clamp(blend, 0.0f, 1.0f);
+
+    data[from] += 1.0f - blend;
+    data[to] += blend;
+
+    SetWeights(weights);
+}
+
+void LightmapSet::SetWeights(const Vector4 &weights)
+{
+    if (weights == weights_)
+    {
+        return;
+    }
+
+    weights_ = weights;
+
+    if (material_)
+    {
+        material_->SetShaderParameter("LightmapWeights", weights_);
+    }
+}
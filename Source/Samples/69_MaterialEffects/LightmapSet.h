@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Graphics/GraphicsDefs.h>
+#include <Urho3D/Graphics/Texture2D.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class Material;
+}
+
+//=============================================================================
+// set of lightmaps loaded once and bound to spare texture units of a material,
+// the DiffLightMapBlend technique mixes them with a single weights uniform
+//=============================================================================
+class LightmapSet : public Object
+{
+    URHO3D_OBJECT(LightmapSet, Object);
+
+public:
+    LightmapSet(Context *context);
+    virtual ~LightmapSet(){}
+
+    /// Load pathName000.ext, pathName001.ext, ... up to MAX_LIGHTMAPS.
+    bool Load(const String &pathName, const String &ext, unsigned count);
+    /// Bind the set to the lightmap units of a material.
+    void Apply(Material *material);
+
+    /// Show a single lightmap.
+    void SetLightmap(unsigned index);
+    /// Cross-fade between two lightmaps, blend 0 shows from, 1 shows to.
+    void SetBlend(unsigned from, unsigned to, float blend);
+
+    unsigned GetNumLightmaps() const { return lightmaps_.Size(); }
+    Texture2D* GetLightmap(unsigned index) const;
+
+    static const unsigned MAX_LIGHTMAPS = 4;
+
+protected:
+    void SetWeights(const Vector4 &weights);
+
+protected:
+    Vector<SharedPtr<Texture2D> > lightmaps_;
+    WeakPtr<Material>             material_;
+    Vector4                       weights_;
+};
@@ -0,0 +1,416 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/BillboardSet.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/Deserializer.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/Serializer.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "MaterialAnimator.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+static const char* trackTypeNames[] =
+{
+    "float",
+    "vector2",
+    "vector3",
+    "vector4",
+    "color",
+    0
+};
+
+static const char* wrapModeNames[] =
+{
+    "loop",
+    "clamp",
+    0
+};
+
+//=============================================================================
+//=============================================================================
+void MaterialAnimator::RegisterObject(Context* context)
+{
+    context->RegisterFactory<MaterialAnimator>();
+}
+
+MaterialAnimator::MaterialAnimator(Context* context)
+    : LogicComponent(context)
+    , elapsedTime_(0.0)
+    , updateInvisible_(false)
+    , updateUSec_(0)
+    , numUpdates_(0)
+{
+    SetUpdateEventMask(USE_UPDATE);
+}
+
+bool MaterialAnimator::LoadTracks(const String &fileName)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    if (GetExtension(fileName) == ".xml")
+    {
+        XMLFile *xmlFile = cache->GetResource<XMLFile>(fileName);
+        return xmlFile && LoadXML(xmlFile->GetRoot());
+    }
+
+    SharedPtr<File> file = cache->GetFile(fileName);
+    return file && LoadBinary(*file);
+}
+
+bool MaterialAnimator::LoadXML(const XMLElement &source)
+{
+    if (source.GetName() != "materialanimation")
+    {
+        URHO3D_LOGERROR("MaterialAnimator: root element is not materialanimation");
+        return false;
+    }
+
+    for (XMLElement trackElem = source.GetChild("track"); trackElem; trackElem = trackElem.GetNext("track"))
+    {
+        String nodeName = trackElem.GetAttribute("node");
+        String materialName = trackElem.GetAttribute("material");
+        SharedPtr<Material> material;
+        WeakPtr<Drawable> drawable;
+
+        if (!ResolveTarget(nodeName, materialName, material, drawable))
+        {
+            continue;
+        }
+
+        MatAnimTrackType type = (MatAnimTrackType)GetStringListIndex(trackElem.GetAttribute("type").CString(), trackTypeNames, MatAnimTrack_Vector4);
+        MatAnimWrapMode wrap = (MatAnimWrapMode)GetStringListIndex(trackElem.GetAttribute("wrap").CString(), wrapModeNames, MatAnimWrap_Loop);
+        float timeOffset = trackElem.HasAttribute("offset") ? trackElem.GetFloat("offset") : 0.0f;
+
+        PODVector<MatAnimKey> keys;
+        for (XMLElement keyElem = trackElem.GetChild("key"); keyElem; keyElem = keyElem.GetNext("key"))
+        {
+            MatAnimKey key;
+            key.time_ = keyElem.GetFloat("time");
+            key.value_ = ToVector4(keyElem.GetAttribute("value"), true);
+            keys.Push(key);
+        }
+
+        unsigned idx = AddTrack(material, trackElem.GetAttribute("parameter"), type, keys, wrap, timeOffset, drawable);
+        if (idx != M_MAX_UNSIGNED)
+        {
+            targetNodes_[idx] = nodeName;
+            targetMaterials_[idx] = materialName;
+        }
+    }
+
+    return tracks_.Size() > 0;
+}
+
+bool MaterialAnimator::LoadBinary(Deserializer &source)
+{
+    if (source.ReadFileID() != "MANI")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid material animation file");
+        return false;
+    }
+
+    unsigned numTracks = source.ReadUInt();
+
+    for ( unsigned i = 0; i < numTracks; ++i )
+    {
+        String nodeName = source.ReadString();
+        String materialName = source.ReadString();
+        String parameter = source.ReadString();
+        MatAnimTrackType type = (MatAnimTrackType)source.ReadUByte();
+        MatAnimWrapMode wrap = (MatAnimWrapMode)source.ReadUByte();
+        float timeOffset = source.ReadFloat();
+        unsigned numKeys = source.ReadUInt();
+
+        // a key is a float time and a Vector4 value, a count the stream cannot hold is corrupt data
+        const unsigned keySize = sizeof(float) + sizeof(Vector4);
+        if (type > MatAnimTrack_Color || wrap > MatAnimWrap_Clamp || numKeys > (source.GetSize() - source.GetPosition()) / keySize)
+        {
+            URHO3D_LOGERROR(source.GetName() + ": corrupt material animation track " + String(i));
+            return false;
+        }
+
+        PODVector<MatAnimKey> keys(numKeys);
+        for ( unsigned k = 0; k < numKeys; ++k )
+        {
+            keys[k].time_ = source.ReadFloat();
+            keys[k].value_ = source.ReadVector4();
+        }
+
+        SharedPtr<Material> material;
+        WeakPtr<Drawable> drawable;
+
+        if (!ResolveTarget(nodeName, materialName, material, drawable))
+        {
+            continue;
+        }
+
+        unsigned idx = AddTrack(material, parameter, type, keys, wrap, timeOffset, drawable);
+        if (idx != M_MAX_UNSIGNED)
+        {
+            targetNodes_[idx] = nodeName;
+            targetMaterials_[idx] = materialName;
+        }
+    }
+
+    return tracks_.Size() > 0;
+}
+
+bool MaterialAnimator::SaveBinary(Serializer &dest) const
+{
+    if (!dest.WriteFileID("MANI"))
+        return false;
+
+    dest.WriteUInt(tracks_.Size());
+
+    for ( unsigned i = 0; i < tracks_.Size(); ++i )
+    {
+        const TrackInfo &track = tracks_[i];
+
+        dest.WriteString(targetNodes_[i]);
+        dest.WriteString(targetMaterials_[i]);
+        dest.WriteString(parameters_[i]);
+        dest.WriteUByte((unsigned char)track.type_);
+        dest.WriteUByte((unsigned char)track.wrap_);
+        dest.WriteFloat(track.timeOffset_);
+        dest.WriteUInt(track.numKeys_);
+
+        for ( unsigned k = track.firstKey_; k < track.firstKey_ + track.numKeys_; ++k )
+        {
+            dest.WriteFloat(keyTimes_[k]);
+            dest.WriteVector4(keyValues_[k]);
+        }
+    }
+
+    return true;
+}
+
+bool MaterialAnimator::ResolveTarget(const String &nodeName, const String &materialName,
+                                     SharedPtr<Material> &material, WeakPtr<Drawable> &drawable)
+{
+    if (!nodeName.Empty())
+    {
+        Node *node = GetScene() ? GetScene()->GetChild(nodeName, true) : NULL;
+
+        if (node)
+        {
+            // see UVSequencer, only billboardset and staticmodel are looked for
+            if (node->GetComponent<StaticModel>())
+            {
+                drawable = node->GetComponent<StaticModel>();
+                material = node->GetComponent<StaticModel>()->GetMaterial();
+            }
+            else if (node->GetComponent<BillboardSet>())
+            {
+                drawable = node->GetComponent<BillboardSet>();
+                material = node->GetComponent<BillboardSet>()->GetMaterial();
+            }
+        }
+    }
+    else if (!materialName.Empty())
+    {
+        material = GetSubsystem<ResourceCache>()->GetResource<Material>(materialName);
+    }
+
+    if (!material)
+    {
+        URHO3D_LOGWARNING("MaterialAnimator: unable to resolve track target " + (nodeName.Empty() ? materialName : nodeName));
+        return false;
+    }
+
+    return true;
+}
+
+unsigned MaterialAnimator::AddTrack(Material *material, const String &parameter, MatAnimTrackType type,
+                                    const PODVector<MatAnimKey> &keys, MatAnimWrapMode wrap,
+                                    float timeOffset, Drawable *drawable)
+{
+    if (!material || parameter.Empty() || keys.Empty())
+    {
+        return M_MAX_UNSIGNED;
+    }
+
+    TrackInfo track;
+    track.firstKey_ = keyTimes_.Size();
+    track.numKeys_ = keys.Size();
+    track.lastKey_ = 0;
+    track.duration_ = keys.Back().time_;
+    track.timeOffset_ = timeOffset;
+    track.type_ = type;
+    track.wrap_ = wrap;
+
+    for ( unsigned i = 0; i < keys.Size(); ++i )
+    {
+        keyTimes_.Push(keys[i].time_);
+        keyValues_.Push(keys[i].value_);
+    }
+
+    tracks_.Push(track);
+    trackValues_.Push(keys[0].value_);
+    materials_.Push(SharedPtr<Material>(material));
+    parameters_.Push(parameter);
+    drawables_.Push(WeakPtr<Drawable>(drawable));
+    targetNodes_.Push(String::EMPTY);
+    targetMaterials_.Push(material->GetName());
+
+    return tracks_.Size() - 1;
+}
+
+void MaterialAnimator::RemoveAllTracks()
+{
+    tracks_.Clear();
+    keyTimes_.Clear();
+    keyValues_.Clear();
+    trackValues_.Clear();
+    materials_.Clear();
+    parameters_.Clear();
+    drawables_.Clear();
+    targetNodes_.Clear();
+    targetMaterials_.Clear();
+}
+
+float MaterialAnimator::GetAverageUpdateUSec() const
+{
+    return numUpdates_ ? (float)updateUSec_ / (float)numUpdates_ : 0.0f;
+}
+
+void MaterialAnimator::ResetUpdateStats()
+{
+    updateUSec_ = 0;
+    numUpdates_ = 0;
+}
+
+void MaterialAnimator::Update(float timeStep)
+{
+    URHO3D_PROFILE(MaterialAnimator);
+    HiresTimer timer;
+
+    elapsedTime_ += timeStep;
+
+    EvaluateTracks();
+    ApplyTracks();
+
+    updateUSec_ += timer.GetUSec(false);
+    ++numUpdates_;
+}
+
+void MaterialAnimator::EvaluateTracks()
+{
+    const float *keyTimes = keyTimes_.Buffer();
+    const Vector4 *keyValues = keyValues_.Buffer();
+    Vector4 *values = trackValues_.Buffer();
+    TrackInfo *tracks = tracks_.Buffer();
+    const unsigned numTracks = tracks_.Size();
+
+    for ( unsigned i = 0; i < numTracks; ++i )
+    {
+        TrackInfo &track = tracks[i];
+        const float *times = keyTimes + track.firstKey_;
+        const Vector4 *keys = keyValues + track.firstKey_;
+
+        if (track.numKeys_ == 1 || track.duration_ <= 0.0f)
+        {
+            values[i] = keys[0];
+            continue;
+        }
+
+        // a negative offset puts the time before zero, fmod keeps the sign so wrap it into [0, duration)
+        double localTime = elapsedTime_ + track.timeOffset_;
+        float t;
+        if (track.wrap_ == MatAnimWrap_Clamp)
+        {
+            t = (float)Clamp(localTime, 0.0, (double)track.duration_);
+        }
+        else
+        {
+            double wrapped = fmod(localTime, (double)track.duration_);
+            t = (float)(wrapped < 0.0 ? wrapped + track.duration_ : wrapped);
+        }
+
+        // time only moves forward between wraps, start the key search at the last key used
+        unsigned k = track.lastKey_;
+        if (t < times[k])
+        {
+            k = 0;
+        }
+        while (k + 2 < track.numKeys_ && t >= times[k + 1])
+        {
+            ++k;
+        }
+        track.lastKey_ = k;
+
+        float span = times[k + 1] - times[k];
+        float f = span > 0.0f ? Clamp((t - times[k]) / span, 0.0f, 1.0f) : 1.0f;
+        values[i] = keys[k] + (keys[k + 1] - keys[k]) * f;
+    }
+}
+
+void MaterialAnimator::ApplyTracks()
+{
+    const Vector4 *values = trackValues_.Buffer();
+    const unsigned numTracks = tracks_.Size();
+
+    for ( unsigned i = 0; i < numTracks; ++i )
+    {
+        Drawable *drawable = drawables_[i];
+        if (drawable && !updateInvisible_ && !drawable->IsInView())
+        {
+            continue;
+        }
+
+        const Vector4 &value = values[i];
+
+        switch (tracks_[i].type_)
+        {
+        case MatAnimTrack_Float:
+            materials_[i]->SetShaderParameter(parameters_[i], value.x_);
+            break;
+
+        case MatAnimTrack_Vector2:
+            materials_[i]->SetShaderParameter(parameters_[i], Vector2(value.x_, value.y_));
+            break;
+
+        case MatAnimTrack_Vector3:
+            materials_[i]->SetShaderParameter(parameters_[i], Vector3(value.x_, value.y_, value.z_));
+            break;
+
+        case MatAnimTrack_Vector4:
+            materials_[i]->SetShaderParameter(parameters_[i], value);
+            break;
+
+        case MatAnimTrack_Color:
+            materials_[i]->SetShaderParameter(parameters_[i], Color(value.x_, value.y_, value.z_, value.w_));
+            break;
+        }
+    }
+}
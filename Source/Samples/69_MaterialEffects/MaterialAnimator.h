@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Scene/LogicComponent.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class Deserializer;
+class Drawable;
+class Material;
+class Serializer;
+class XMLElement;
+}
+
+//=============================================================================
+//=============================================================================
+enum MatAnimTrackType
+{
+    MatAnimTrack_Float,     // 0
+    MatAnimTrack_Vector2,   // 1
+    MatAnimTrack_Vector3,   // 2
+    MatAnimTrack_Vector4,   // 3
+    MatAnimTrack_Color,     // 4
+};
+
+enum MatAnimWrapMode
+{
+    MatAnimWrap_Loop,
+    MatAnimWrap_Clamp,
+};
+
+struct MatAnimKey
+{
+    float   time_;
+    Vector4 value_;
+};
+
+//=============================================================================
+// evaluates keyframed shader parameter tracks for any number of materials,
+// track data is kept in flat arrays and evaluated in one pass per frame
+//=============================================================================
+class MaterialAnimator : public LogicComponent
+{
+    URHO3D_OBJECT(MaterialAnimator, LogicComponent);
+
+public:
+    MaterialAnimator(Context* context);
+    virtual ~MaterialAnimator(){}
+
+    static void RegisterObject(Context* context);
+
+    /// Load tracks from an xml or a binary (.mani) file. Track targets are resolved against the scene.
+    bool LoadTracks(const String &fileName);
+    bool LoadXML(const XMLElement &source);
+    bool LoadBinary(Deserializer &source);
+    bool SaveBinary(Serializer &dest) const;
+
+    /// Add a track, if drawable is set the material is only written while the drawable is in view.
+    unsigned AddTrack(Material *material, const String &parameter, MatAnimTrackType type,
+                      const PODVector<MatAnimKey> &keys, MatAnimWrapMode wrap = MatAnimWrap_Loop,
+                      float timeOffset = 0.0f, Drawable *drawable = NULL);
+    void RemoveAllTracks();
+
+    unsigned GetNumTracks() const { return tracks_.Size(); }
+    /// Keep writing tracks whose drawable is out of view, nothing is in view without a renderer.
+    void SetUpdateInvisible(bool enable) { updateInvisible_ = enable; }
+    long long GetUpdateUSec() const { return updateUSec_; }
+    float GetAverageUpdateUSec() const;
+    void ResetUpdateStats();
+
+protected:
+    virtual void Update(float timeStep);
+
+    void EvaluateTracks();
+    void ApplyTracks();
+    bool ResolveTarget(const String &nodeName, const String &materialName,
+                       SharedPtr<Material> &material, WeakPtr<Drawable> &drawable);
+
+protected:
+    struct TrackInfo
+    {
+        unsigned firstKey_;
+        unsigned numKeys_;
+        unsigned lastKey_;
+        float    duration_;
+        float    timeOffset_;
+        unsigned type_;
+        unsigned wrap_;
+    };
+
+    // hot data, walked linearly every frame
+    PODVector<TrackInfo>         tracks_;
+    PODVector<float>             keyTimes_;
+    PODVector<Vector4>           keyValues_;
+    PODVector<Vector4>           trackValues_;
+
+    // cold data, indexed the same as tracks_
+    Vector<SharedPtr<Material> > materials_;
+    Vector<String>               parameters_;
+    Vector<WeakPtr<Drawable> >   drawables_;
+    Vector<String>               targetNodes_;
+    Vector<String>               targetMaterials_;
+
+    double                       elapsedTime_;
+    bool                         updateInvisible_;
+
+    // stats
+    long long                    updateUSec_;
+    unsigned                     numUpdates_;
+};
@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/RenderSurface.h>
+#include <Urho3D/Graphics/Viewport.h>
+
+#include "ReflectionTargetPool.h"
+#include "RenderTargetFormat.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+ReflectionTargetPool::ReflectionTargetPool(Context *context)
+    : Object(context)
+    , format_(Graphics::GetRGBFormat())
+    , numAllocated_(0)
+{
+}
+
+SharedPtr<Texture2D> ReflectionTargetPool::Acquire(int size)
+{
+    PruneExpired();
+
+    Vector<SharedPtr<Texture2D> > &freeList = freeTargets_[size];
+
+    if (freeList.Size())
+    {
+        SharedPtr<Texture2D> texture = freeList.Back();
+        freeList.Pop();
+        return texture;
+    }
+
+    SharedPtr<Texture2D> renderTexture(new Texture2D(context_));
+    renderTexture->SetSize(size, size, format_, TEXTURE_RENDERTARGET);
+    renderTexture->SetFilterMode(FILTER_BILINEAR);
+
+    // rendered only when the owner queues it
+    renderTexture->GetRenderSurface()->SetUpdateMode(SURFACE_MANUALUPDATE);
+    targets_.Push(WeakPtr<Texture2D>(renderTexture));
+    ++numAllocated_;
+
+    return renderTexture;
+}
+
+void ReflectionTargetPool::Release(Texture2D *texture)
+{
+    if (!texture)
+    {
+        return;
+    }
+
+    texture->GetRenderSurface()->SetViewport(0, NULL);
+
+    if (texture->GetFormat() != format_)
+    {
+        targets_.Remove(WeakPtr<Texture2D>(texture));
+        --numAllocated_;
+        return;
+    }
+
+    freeTargets_[texture->GetWidth()].Push(SharedPtr<Texture2D>(texture));
+}
+
+void ReflectionTargetPool::SetFormat(unsigned format)
+{
+    if (format == format_)
+    {
+        return;
+    }
+
+    format_ = format;
+
+    // free targets are only referenced here
+    for (HashMap<int, Vector<SharedPtr<Texture2D> > >::Iterator itr = freeTargets_.Begin(); itr != freeTargets_.End(); ++itr)
+    {
+        for ( unsigned i = 0; i < itr->second_.Size(); ++i )
+        {
+            targets_.Remove(WeakPtr<Texture2D>(itr->second_[i]));
+        }
+
+        numAllocated_ -= itr->second_.Size();
+    }
+
+    freeTargets_.Clear();
+}
+
+unsigned ReflectionTargetPool::GetNumFree() const
+{
+    unsigned numFree = 0;
+
+    for (HashMap<int, Vector<SharedPtr<Texture2D> > >::ConstIterator itr = freeTargets_.Begin(); itr != freeTargets_.End(); ++itr)
+    {
+        numFree += itr->second_.Size();
+    }
+
+    return numFree;
+}
+
+void ReflectionTargetPool::PruneExpired()
+{
+    for ( unsigned i = 0; i < targets_.Size(); )
+    {
+        if (targets_[i].Expired())
+        {
+            targets_.Erase(i);
+            --numAllocated_;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+unsigned ReflectionTargetPool::AppendMemoryReport(String &report)
+{
+    unsigned totalBytes = 0;
+
+    PruneExpired();
+
+    for ( unsigned i = 0; i < targets_.Size(); ++i )
+    {
+        Texture2D *texture = targets_[i];
+
+        if (!texture)
+        {
+            continue;
+        }
+
+        unsigned bytes = texture->GetWidth() * texture->GetHeight() * RenderTargetFormat::GetBytesPerPixel(texture->GetFormat());
+        report.AppendWithFormat("  reflection %dx%d  format 0x%x  %u bytes\n", texture->GetWidth(), texture->GetHeight(),
+                                texture->GetFormat(), bytes);
+        totalBytes += bytes;
+    }
+
+    return totalBytes;
+}
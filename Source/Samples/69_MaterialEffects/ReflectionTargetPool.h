@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Graphics/Texture2D.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+// square render targets shared by the reflections, a released target is
+// handed to the next reflection asking for the same size
+//=============================================================================
+class ReflectionTargetPool : public Object
+{
+    URHO3D_OBJECT(ReflectionTargetPool, Object);
+
+public:
+    ReflectionTargetPool(Context *context);
+    virtual ~ReflectionTargetPool(){}
+
+    SharedPtr<Texture2D> Acquire(int size);
+    void Release(Texture2D *texture);
+
+    /// Native format for new targets, targets of the old format are dropped when released.
+    void SetFormat(unsigned format);
+    unsigned GetFormat() const { return format_; }
+
+    unsigned GetNumAllocated() const { return numAllocated_; }
+    unsigned GetNumFree() const;
+
+    /// Append one line per live target with its size, format and color bytes.
+    unsigned AppendMemoryReport(String &report);
+
+protected:
+    /// Forget targets destroyed without being released.
+    void PruneExpired();
+
+    HashMap<int, Vector<SharedPtr<Texture2D> > > freeTargets_;
+    Vector<WeakPtr<Texture2D> >                 targets_;
+    unsigned                                    format_;
+    unsigned                                    numAllocated_;
+};
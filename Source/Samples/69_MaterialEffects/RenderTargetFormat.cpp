@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/IO/Log.h>
+
+#include "RenderTargetFormat.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+static const char* targetFormatNames[Max_TargetFormats] =
+{
+    "rgba8",
+    "rgb8",
+    "rgba16f",
+    "r11g11b10f",
+    "rgb10a2",
+    "rgb565",
+    "rgba4",
+};
+
+// formats without a Graphics getter, the engine passes native formats straight to the api
+#if defined(URHO3D_OPENGL)
+static const unsigned FORMAT_R11G11B10F = 0x8C3A;   // GL_R11F_G11F_B10F
+static const unsigned FORMAT_RGB10A2    = 0x8059;   // GL_RGB10_A2
+static const unsigned FORMAT_RGB565     = 0x8D62;   // GL_RGB565
+static const unsigned FORMAT_RGBA4      = 0x8056;   // GL_RGBA4
+#elif defined(URHO3D_D3D11)
+static const unsigned FORMAT_R11G11B10F = 26;       // DXGI_FORMAT_R11G11B10_FLOAT
+static const unsigned FORMAT_RGB10A2    = 24;       // DXGI_FORMAT_R10G10B10A2_UNORM
+static const unsigned FORMAT_RGB565     = 85;       // DXGI_FORMAT_B5G6R5_UNORM
+static const unsigned FORMAT_RGBA4      = 115;      // DXGI_FORMAT_B4G4R4A4_UNORM
+#else
+static const unsigned FORMAT_R11G11B10F = 0;        // no d3d9 equivalent
+static const unsigned FORMAT_RGB10A2    = 31;       // D3DFMT_A2B10G10R10
+static const unsigned FORMAT_RGB565     = 23;       // D3DFMT_R5G6B5
+static const unsigned FORMAT_RGBA4      = 26;       // D3DFMT_A4R4G4B4
+#endif
+
+//=============================================================================
+//=============================================================================
+RenderTargetFormat::RenderTargetFormat(Context *context)
+    : Object(context)
+{
+    for ( unsigned i = 0; i < Max_TargetFormats; ++i )
+    {
+        probed_[i] = Probe_Unknown;
+    }
+
+    // always renderable
+    probed_[TargetFormat_RGBA8] = Probe_Supported;
+
+#if defined(URHO3D_OPENGL)
+    // the gl Texture2D derives the upload format and type only for the formats Graphics has getters for,
+    // the packed ones fail to create and log an engine error, no need to probe them
+    probed_[TargetFormat_R11G11B10F] = Probe_Unsupported;
+    probed_[TargetFormat_RGB10A2] = Probe_Unsupported;
+    probed_[TargetFormat_RGB565] = Probe_Unsupported;
+    probed_[TargetFormat_RGBA4] = Probe_Unsupported;
+#endif
+}
+
+unsigned RenderTargetFormat::Select(TargetFormatType type)
+{
+    return GetNativeFormat(Resolve(type));
+}
+
+TargetFormatType RenderTargetFormat::Resolve(TargetFormatType type)
+{
+    TargetFormatType resolved = type;
+
+    while (!IsSupported(resolved))
+    {
+        resolved = GetFallback(resolved);
+    }
+
+    if (resolved != type)
+    {
+        URHO3D_LOGINFO("Render target format " + String(GetName(type)) + " not supported, using " + String(GetName(resolved)));
+    }
+
+    return resolved;
+}
+
+bool RenderTargetFormat::IsSupported(TargetFormatType type)
+{
+    if (probed_[type] == Probe_Unknown)
+    {
+        unsigned format = GetNativeFormat(type);
+        bool supported = false;
+
+        if (format && GetSubsystem<Graphics>())
+        {
+            SharedPtr<Texture2D> texture(new Texture2D(context_));
+            texture->SetNumLevels(1);
+            supported = texture->SetSize(4, 4, format, TEXTURE_RENDERTARGET);
+        }
+
+        probed_[type] = supported ? Probe_Supported : Probe_Unsupported;
+    }
+
+    return probed_[type] == Probe_Supported;
+}
+
+unsigned RenderTargetFormat::GetNativeFormat(TargetFormatType type)
+{
+    switch (type)
+    {
+    case TargetFormat_RGB8:       return Graphics::GetRGBFormat();
+    case TargetFormat_RGBA16F:    return Graphics::GetRGBAFloat16Format();
+    case TargetFormat_R11G11B10F: return FORMAT_R11G11B10F;
+    case TargetFormat_RGB10A2:    return FORMAT_RGB10A2;
+    case TargetFormat_RGB565:     return FORMAT_RGB565;
+    case TargetFormat_RGBA4:      return FORMAT_RGBA4;
+    default:                      return Graphics::GetRGBAFormat();
+    }
+}
+
+TargetFormatType RenderTargetFormat::GetFallback(TargetFormatType type)
+{
+    switch (type)
+    {
+    case TargetFormat_R11G11B10F: return TargetFormat_RGBA16F;
+    case TargetFormat_RGB565:     return TargetFormat_RGB8;
+    default:                      return TargetFormat_RGBA8;
+    }
+}
+
+TargetFormatType RenderTargetFormat::GetType(const String &name, TargetFormatType defaultType)
+{
+    for ( unsigned i = 0; i < Max_TargetFormats; ++i )
+    {
+        if (name.Compare(targetFormatNames[i], false) == 0)
+        {
+            return (TargetFormatType)i;
+        }
+    }
+
+    return defaultType;
+}
+
+const char* RenderTargetFormat::GetName(TargetFormatType type)
+{
+    return type < Max_TargetFormats ? targetFormatNames[type] : "";
+}
+
+unsigned RenderTargetFormat::GetBytesPerPixel(unsigned nativeFormat)
+{
+    if (nativeFormat == Graphics::GetRGBAFloat16Format() || nativeFormat == Graphics::GetRGBA16Format())
+    {
+        return 8;
+    }
+    if (nativeFormat == Graphics::GetRGBAFloat32Format())
+    {
+        return 16;
+    }
+    if (nativeFormat && (nativeFormat == FORMAT_RGB565 || nativeFormat == FORMAT_RGBA4))
+    {
+        return 2;
+    }
+
+    // rgb8 is padded to 32 bits by the drivers
+    return 4;
+}
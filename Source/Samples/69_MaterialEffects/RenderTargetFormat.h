@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+//=============================================================================
+enum TargetFormatType
+{
+    TargetFormat_RGBA8,
+    TargetFormat_RGB8,
+    TargetFormat_RGBA16F,
+    TargetFormat_R11G11B10F,    // hdr without alpha, 32 bits
+    TargetFormat_RGB10A2,
+    TargetFormat_RGB565,
+    TargetFormat_RGBA4,
+
+    Max_TargetFormats
+};
+
+//=============================================================================
+// maps render target format choices to the native format of the graphics api
+// and falls back along a chain until one the device can render to is found
+//=============================================================================
+class RenderTargetFormat : public Object
+{
+    URHO3D_OBJECT(RenderTargetFormat, Object);
+
+public:
+    RenderTargetFormat(Context *context);
+    virtual ~RenderTargetFormat(){}
+
+    /// Native format of the first supported type in the fallback chain of type.
+    unsigned Select(TargetFormatType type);
+    /// Supported type the fallback chain of type ends up at.
+    TargetFormatType Resolve(TargetFormatType type);
+    /// Probe by creating a small render target, results are cached.
+    bool IsSupported(TargetFormatType type);
+
+    static unsigned GetNativeFormat(TargetFormatType type);
+    static TargetFormatType GetFallback(TargetFormatType type);
+    static TargetFormatType GetType(const String &name, TargetFormatType defaultType = TargetFormat_RGBA8);
+    static const char* GetName(TargetFormatType type);
+    /// Bytes per pixel of a native format, 4 for formats not listed here.
+    static unsigned GetBytesPerPixel(unsigned nativeFormat);
+
+protected:
+    enum ProbeState
+    {
+        Probe_Unknown,
+        Probe_Supported,
+        Probe_Unsupported,
+    };
+
+    ProbeState probed_[Max_TargetFormats];
+};
@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <math.h>
+
+#include "SceneTimeWrap.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+void SceneTimeWrap::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SceneTimeWrap>();
+
+    URHO3D_ACCESSOR_ATTRIBUTE("wrapPeriod", GetWrapPeriod, SetWrapPeriod, float, 1000.0f, AM_DEFAULT);
+}
+
+SceneTimeWrap::SceneTimeWrap(Context* context)
+    : Component(context)
+    , wrapPeriod_(1000.0f)
+    , totalTime_(0.0)
+{
+}
+
+void SceneTimeWrap::SetWrapPeriod(float period)
+{
+    wrapPeriod_ = Max(period, 1.0f);
+}
+
+void SceneTimeWrap::OnSceneSet(Scene* scene)
+{
+    if (scene)
+    {
+        totalTime_ = scene->GetElapsedTime();
+
+        // the scene adds its time step after its post update, so the wrapped value is written in the engine post update
+        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(SceneTimeWrap, HandleSceneUpdate));
+        SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(SceneTimeWrap, HandlePostUpdate));
+    }
+    else
+    {
+        UnsubscribeFromAllEvents();
+    }
+}
+
+void SceneTimeWrap::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace SceneUpdate;
+
+    // scaled step, time scale and pause still apply
+    totalTime_ += (double)eventData[P_TIMESTEP].GetFloat();
+}
+
+void SceneTimeWrap::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    GetScene()->SetElapsedTime((float)fmod(totalTime_, (double)wrapPeriod_));
+}
@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Scene/Component.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+// keeps the scene elapsed time (cElapsedTime in the shaders) in double
+// precision and hands the renderer a float wrapped to [0, wrapPeriod).
+// the wrap is seamless as long as every scroll speed times the period is a
+// whole number of texture repeats
+//=============================================================================
+class SceneTimeWrap : public Component
+{
+    URHO3D_OBJECT(SceneTimeWrap, Component);
+
+public:
+    SceneTimeWrap(Context* context);
+    virtual ~SceneTimeWrap(){}
+
+    static void RegisterObject(Context* context);
+
+    void SetWrapPeriod(float period);
+    float GetWrapPeriod() const { return wrapPeriod_; }
+    /// Unwrapped time since the component was added.
+    double GetTotalTime() const { return totalTime_; }
+
+protected:
+    virtual void OnSceneSet(Scene* scene);
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+
+protected:
+    float     wrapPeriod_;
+    double    totalTime_;
+};
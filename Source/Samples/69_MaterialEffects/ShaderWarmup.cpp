@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/ShaderVariation.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#include "ShaderWarmup.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+ShaderWarmup::ShaderWarmup(Context *context)
+    : Object(context)
+    , nextEntry_(0)
+    , frameBudgetUSec_(4000)
+    , numCompiled_(0)
+    , numFailed_(0)
+    , totalUSec_(0)
+    , maxUSec_(0)
+{
+}
+
+bool ShaderWarmup::Start(const String &fileName)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    if (!GetSubsystem<Graphics>())
+    {
+        return false;
+    }
+
+    if (!cache->Exists(fileName))
+    {
+        URHO3D_LOGWARNING("shader warm-up: " + fileName + " not found, shaders compile on first use");
+        return false;
+    }
+
+    XMLFile *xmlFile = cache->GetResource<XMLFile>(fileName);
+
+    if (!xmlFile)
+    {
+        return false;
+    }
+
+    entries_.Clear();
+    nextEntry_ = numCompiled_ = numFailed_ = 0;
+    totalUSec_ = maxUSec_ = 0;
+
+    for ( XMLElement elem = xmlFile->GetRoot().GetChild("shader"); elem; elem = elem.GetNext("shader") )
+    {
+        WarmupEntry entry;
+        entry.vs_        = elem.GetAttribute("vs");
+        entry.vsDefines_ = elem.GetAttribute("vsdefines");
+        entry.ps_        = elem.GetAttribute("ps");
+        entry.psDefines_ = elem.GetAttribute("psdefines");
+        entries_.Push(entry);
+    }
+
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(ShaderWarmup, HandleUpdate));
+
+    return true;
+}
+
+bool ShaderWarmup::CompileEntry(unsigned index)
+{
+    Graphics* graphics = GetSubsystem<Graphics>();
+    const WarmupEntry &entry = entries_[index];
+
+    ShaderVariation *vs = graphics->GetShader(VS, entry.vs_, entry.vsDefines_);
+    ShaderVariation *ps = graphics->GetShader(PS, entry.ps_, entry.psDefines_);
+
+    if (!vs || !ps)
+    {
+        return false;
+    }
+
+    // compiles, and links the program on opengl. A variant that fails to compile is not set
+    graphics->SetShaders(vs, ps);
+
+    return graphics->GetVertexShader() == vs && graphics->GetPixelShader() == ps;
+}
+
+void ShaderWarmup::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{
+    HiresTimer frameTimer;
+
+    while (!IsFinished())
+    {
+        HiresTimer entryTimer;
+
+        if (CompileEntry(nextEntry_++))
+        {
+            ++numCompiled_;
+        }
+        else
+        {
+            ++numFailed_;
+        }
+
+        long long entryUSec = entryTimer.GetUSec(false);
+        totalUSec_ += entryUSec;
+        maxUSec_ = Max(maxUSec_, entryUSec);
+
+        if (frameTimer.GetUSec(false) >= frameBudgetUSec_)
+        {
+            break;
+        }
+    }
+
+    if (IsFinished())
+    {
+        UnsubscribeFromEvent(E_UPDATE);
+
+        URHO3D_LOGINFO("Shader warmup: " + String(numCompiled_) + " variants compiled, " + String(numFailed_) + " failed, " +
+                       String(GetTotalMSec()) + " ms total, " + String(GetMaxMSec()) + " ms max");
+    }
+}
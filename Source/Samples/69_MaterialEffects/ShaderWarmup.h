@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+// compiles a warm-up list (engine shader precache xml, see the ShaderVariantList
+// tool) a few variants per frame so effects don't hitch when first seen
+//=============================================================================
+class ShaderWarmup : public Object
+{
+    URHO3D_OBJECT(ShaderWarmup, Object);
+
+public:
+    ShaderWarmup(Context *context);
+    virtual ~ShaderWarmup(){}
+
+    /// Load the list and start compiling on the following updates.
+    bool Start(const String &fileName);
+    /// Milliseconds of compiling allowed per frame, at least one variant is compiled per frame.
+    void SetFrameBudget(float msec) { frameBudgetUSec_ = (long long)(msec * 1000.0f); }
+
+    bool IsFinished() const { return nextEntry_ >= entries_.Size(); }
+    float GetProgress() const { return entries_.Size() ? (float)nextEntry_ / (float)entries_.Size() : 1.0f; }
+    unsigned GetNumEntries() const { return entries_.Size(); }
+    unsigned GetNumCompiled() const { return numCompiled_; }
+    unsigned GetNumFailed() const { return numFailed_; }
+    float GetTotalMSec() const { return (float)totalUSec_ / 1000.0f; }
+    float GetMaxMSec() const { return (float)maxUSec_ / 1000.0f; }
+
+protected:
+    bool CompileEntry(unsigned index);
+
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+
+protected:
+    struct WarmupEntry
+    {
+        String vs_;
+        String vsDefines_;
+        String ps_;
+        String psDefines_;
+    };
+
+    Vector<WarmupEntry> entries_;
+    unsigned            nextEntry_;
+    long long           frameBudgetUSec_;
+
+    // stats
+    unsigned            numCompiled_;
+    unsigned            numFailed_;
+    long long           totalUSec_;
+    long long           maxUSec_;
+};
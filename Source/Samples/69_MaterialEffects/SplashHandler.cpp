@@ -21,6 +21,7 @@
 //
 
 #include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/Graphics/AnimationController.h>
 #include <Urho3D/Graphics/DrawableEvents.h>
 #include <Urho3D/Graphics/AnimatedModel.h>
@@ -51,6 +52,7 @@ void SplashHandler::RegisterObject(Context* context)
 
 SplashHandler::SplashHandler(Context *context) 
     : LogicComponent(context)
+    , updateUSec_(0)
 {
     SetUpdateEventMask(USE_FIXEDUPDATE);
 }
@@ -99,6 +101,8 @@ bool SplashHandler::LoadSplashList(const String &strlist)
 
 void SplashHandler::FixedUpdate(float timeStep)
 {
+    HiresTimer timer;
+
     for ( unsigned i = 0; i < activeSplashList_.Size(); ++i )
     {
         SplashData *splashData = activeSplashList_[i];
@@ -149,11 +153,14 @@ void SplashHandler::FixedUpdate(float timeStep)
             --i;
         }
     }
+
+    updateUSec_ += timer.GetUSec(false);
 }
 
 void SplashHandler::HandleSplashEvent(StringHash eventType, VariantMap& eventData)
 {
     using namespace SplashEvent;
+    HiresTimer timer;
 
 	Vector3 pos = eventData[P_POS].GetVector3();
 	Vector3 dir = eventData[P_DIR].GetVector3();
@@ -179,6 +186,8 @@ void SplashHandler::HandleSplashEvent(StringHash eventType, VariantMap& eventDat
             break;
         }
     }
+
+    updateUSec_ += timer.GetUSec(false);
 }
 
 bool SplashHandler::CreateDrawableObj(SplashData *splashData)
@@ -118,6 +118,10 @@ public:
     static void RegisterObject(Context* context);
     bool LoadSplashList(const String &strlist);
 
+    unsigned GetNumActiveSplashes() const { return activeSplashList_.Size(); }
+    long long GetUpdateUSec() const { return updateUSec_; }
+    void ResetUpdateStats() { updateUSec_ = 0; }
+
 protected:
     virtual void Start();
     virtual void FixedUpdate(float timeStep);
@@ -128,6 +132,9 @@ protected:
 protected:
     Vector<SharedPtr<SplashData> > registeredSplashList_;
     Vector<SharedPtr<SplashData> > activeSplashList_;
+
+    // stats, splash creation and the per step update
+    long long                      updateUSec_;
 };
 
 //=============================================================================
@@ -21,6 +21,7 @@
 //
 
 #include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/Scene/Scene.h>
 #include <Urho3D/Resource/ResourceCache.h>
 #include <Urho3D/Graphics/StaticModel.h>
@@ -28,6 +29,7 @@
 #include <Urho3D/Graphics/Texture2D.h>
 #include <Urho3D/Graphics/Material.h>
 #include <stdio.h>
+#include <math.h>
 #include <SDL/SDL_log.h>
 
 #include "UVSequencer.h"
@@ -43,6 +45,7 @@ void UVSequencer::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("uvSeqType",       int,        uvSeqType_,      0,             AM_DEFAULT );
     URHO3D_ATTRIBUTE("enabled",         bool,       enabled_,        false,         AM_DEFAULT );
     URHO3D_ATTRIBUTE("repeat",          bool,       repeat_,         false,         AM_DEFAULT );
+    URHO3D_ATTRIBUTE("updateInvisible", bool,       updateInvisible_, false,        AM_DEFAULT );
 
     // uv scroll
     URHO3D_ATTRIBUTE("uScrollSpeed",    float,      uScrollSpeed_,   0.0f,          AM_DEFAULT );
@@ -76,13 +79,17 @@ UVSequencer::UVSequencer(Context* context)
     , timePerFrame_(0)
     , enabled_(false)
     , repeat_(false)
+    , updateInvisible_(false)
     , curUVOffset_(Vector2::ZERO)
+    , uScroll_(0.0)
+    , vScroll_(0.0)
     , curFrameIdx_(0)
     , curImageIdx_(0)
     , swapTUenum_(0)
     , swapBegIdx_(0)
     , swapEndIdx_(0)
     , decFormat_(NULL)
+    , updateUSec_(0)
 {
     SetUpdateEventMask(USE_FIXEDUPDATE);
 }
@@ -139,6 +146,8 @@ bool UVSequencer::Reset()
     curFrameIdx_ = 0;
     curImageIdx_ = 0;
     curUVOffset_ = Vector2::ZERO;
+    uScroll_ = 0.0;
+    vScroll_ = 0.0;
     seqTimer_.Reset();
 
     // and specifics 
@@ -154,6 +163,8 @@ bool UVSequencer::Reset()
 
     case UVSeq_UVFrame:
         InitUVFrameSize();
+        InitUVFrameDefines();
+        UpdateUVFrameShader();
         UpdateUVFrame();
         break;
 
@@ -187,44 +198,81 @@ void UVSequencer::InitUVFrameSize()
 {
     uvFrameSize_.x_ = 1.0f/(float)cols_;
     uvFrameSize_.y_ = 1.0f/(float)rows_;
+
+    // reciprocals here, the vertex shader only does a mad per vertex
+    componentMat_->SetShaderParameter("FrameSize", uvFrameSize_);
+}
+
+void UVSequencer::InitUVFrameDefines()
+{
+    // the materials declare EMISSIONBOOST/MASKEDGES themselves; this only brings the defines in line
+    // with MultAddEmission/MaskEdges if a material changes them. defines set by others (e.g. HWDEPTH
+    // for the soft variant) are kept
+    Vector<String> tokens = componentMat_->GetPixelShaderDefines().Split(' ');
+    tokens.Remove("EMISSIONBOOST");
+    tokens.Remove("MASKEDGES");
+
+    if (componentMat_->GetShaderParameter("MultAddEmission").GetFloat() > 0.0f)
+    {
+        tokens.Push("EMISSIONBOOST");
+    }
+    if (componentMat_->GetShaderParameter("MaskEdges").GetFloat() > 0.0f)
+    {
+        tokens.Push("MASKEDGES");
+    }
+
+    String defines = String::Joined(tokens, " ");
+
+    // materials shared by several sequencers only clone their techniques once
+    if (componentMat_->GetPixelShaderDefines() != defines)
+    {
+        componentMat_->SetPixelShaderDefines(defines);
+    }
 }
 
 void UVSequencer::FixedUpdate(float timeStep)
 {
-    // skip if not in view
-    if (!drawableComponent_->IsInView())
-        return;
+    HiresTimer timer;
 
-    // update
-    switch (uvSeqType_)
+    // skip if not in view
+    if (updateInvisible_ || drawableComponent_->IsInView())
     {
-    case UVSeq_UScroll:
-        UpdateUScroll(timeStep);
-        break;
+        // update
+        switch (uvSeqType_)
+        {
+        case UVSeq_UScroll:
+            UpdateUScroll(timeStep);
+            break;
 
-    case UVSeq_VScroll:
-        UpdateVScroll(timeStep);
-        break;
+        case UVSeq_VScroll:
+            UpdateVScroll(timeStep);
+            break;
 
-    case UVSeq_UVFrame:
-        UpdateUVFrame();
-        break;
+        case UVSeq_UVFrame:
+            UpdateUVFrame();
+            break;
 
-    case UVSeq_SwapImage:
-        UpdateSwapImage();
-        break;
+        case UVSeq_SwapImage:
+            UpdateSwapImage();
+            break;
+        }
     }
+
+    updateUSec_ += timer.GetUSec(false);
 }
 
 void UVSequencer::UpdateUScroll(float timeStep)
 {
-    curUVOffset_.x_ += uScrollSpeed_ + Sign(uScrollSpeed_) *  timeStep * timerFraction_;
+    // accumulate in double and wrap to one texture repeat, the float offset never loses precision
+    uScroll_ = fmod(uScroll_ + uScrollSpeed_ + Sign(uScrollSpeed_) * timeStep * timerFraction_, 1.0);
+    curUVOffset_.x_ = (float)uScroll_;
     componentMat_->SetShaderParameter("UOffset", Vector4(1.0f, 0.0f, 0.0f, curUVOffset_.x_));
 }
 
 void UVSequencer::UpdateVScroll(float timeStep)
 {
-    curUVOffset_.y_ += vScrollSpeed_ + Sign(vScrollSpeed_) * timeStep * timerFraction_;
+    vScroll_ = fmod(vScroll_ + vScrollSpeed_ + Sign(vScrollSpeed_) * timeStep * timerFraction_, 1.0);
+    curUVOffset_.y_ = (float)vScroll_;
     componentMat_->SetShaderParameter("VOffset", Vector4(0.0f, 1.0f, 0.0f, curUVOffset_.y_));
 }
 
@@ -259,7 +307,7 @@ void UVSequencer::UpdateUVFrameShader()
     float curRow = (float)(curFrameIdx_ / cols_);
     float curCol = (float)(curFrameIdx_ % cols_);
 
-    componentMat_->SetShaderParameter("CurRowCol", Vector2(curRow, curCol));
+    componentMat_->SetShaderParameter("FrameOffset", Vector2(curCol * uvFrameSize_.x_, curRow * uvFrameSize_.y_));
 }
 
 void UVSequencer::UpdateSwapImage()
@@ -53,6 +53,11 @@ public:
     virtual void DelayedStart();
     bool SetEnabled(bool enable);
     bool Reset();
+    int GetCurrentFrame() const { return curFrameIdx_; }
+    /// Keep updating while the drawable is out of view, nothing is in view without a renderer.
+    void SetUpdateInvisible(bool enable) { updateInvisible_ = enable; }
+    long long GetUpdateUSec() const { return updateUSec_; }
+    void ResetUpdateStats() { updateUSec_ = 0; }
 
 protected:
     virtual void FixedUpdate(float timeStep);
@@ -65,6 +70,7 @@ protected:
 
     void InitSwapDecFormat();
     void InitUVFrameSize();
+    void InitUVFrameDefines();
     static const char *UVSequencer::GetDecFormat(int idx, bool leadingZero);
     
 protected:
@@ -75,6 +81,7 @@ protected:
     int               uvSeqType_;
     bool              enabled_;
     bool              repeat_;
+    bool              updateInvisible_;
 
     // uv scroll
     float             uScrollSpeed_;
@@ -98,10 +105,14 @@ protected:
 
     // status update
     Vector2           curUVOffset_;
+    double            uScroll_;
+    double            vScroll_;
     Vector2           uvFrameSize_;
     int               curFrameIdx_;
     int               curImageIdx_;
     Timer             seqTimer_;
 
+    // stats
+    long long         updateUSec_;
 };
 
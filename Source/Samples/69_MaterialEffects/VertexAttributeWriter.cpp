@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/IO/Log.h>
+
+#include "VertexAttributeWriter.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+VertexAttributeWriter::VertexAttributeWriter(Context *context)
+    : Object(context)
+    , vertexSize_(0)
+    , numVertices_(0)
+    , colorOffset_(M_MAX_UNSIGNED)
+    , dirtyMin_(M_MAX_UNSIGNED)
+    , dirtyMax_(0)
+    , numUploadedVertices_(0)
+{
+}
+
+bool VertexAttributeWriter::SetBuffer(VertexBuffer *vbuffer)
+{
+    vbuffer_ = vbuffer;
+    shadowData_.Clear();
+    vertexSize_ = 0;
+    numVertices_ = 0;
+    colorOffset_ = M_MAX_UNSIGNED;
+    dirtyMin_ = M_MAX_UNSIGNED;
+    dirtyMax_ = 0;
+
+    UnsubscribeFromEvent(E_RENDERUPDATE);
+
+    if (!vbuffer)
+    {
+        return false;
+    }
+
+    // the buffer's own shadow copy is the only readable source on every graphics api
+    if (!vbuffer->GetShadowData())
+    {
+        URHO3D_LOGERROR("VertexAttributeWriter: vertex buffer is not shadowed");
+        vbuffer_ = NULL;
+        return false;
+    }
+
+    vertexSize_ = vbuffer->GetVertexSize();
+    numVertices_ = vbuffer->GetVertexCount();
+    colorOffset_ = vbuffer->GetElementOffset(SEM_COLOR);
+
+    shadowData_.Resize(vertexSize_ * numVertices_);
+    memcpy(shadowData_.Buffer(), vbuffer->GetShadowData(), shadowData_.Size());
+
+    SubscribeToEvent(E_RENDERUPDATE, URHO3D_HANDLER(VertexAttributeWriter, HandleRenderUpdate));
+
+    return true;
+}
+
+unsigned VertexAttributeWriter::GetElementOffset(VertexElementSemantic semantic, unsigned char index) const
+{
+    return vbuffer_ ? vbuffer_->GetElementOffset(semantic, index) : M_MAX_UNSIGNED;
+}
+
+void VertexAttributeWriter::SetElement(unsigned vertex, unsigned offset, const void *data, unsigned size)
+{
+    if (vertex >= numVertices_ || offset + size > vertexSize_)
+    {
+        return;
+    }
+
+    memcpy(&shadowData_[vertex * vertexSize_ + offset], data, size);
+
+    dirtyMin_ = Min(dirtyMin_, vertex);
+    dirtyMax_ = Max(dirtyMax_, vertex);
+}
+
+void VertexAttributeWriter::SetColor(unsigned vertex, unsigned color)
+{
+    if (colorOffset_ != M_MAX_UNSIGNED)
+    {
+        SetElement(vertex, colorOffset_, &color, sizeof(unsigned));
+    }
+}
+
+void VertexAttributeWriter::SetColor(unsigned vertex, const Color &color)
+{
+    SetColor(vertex, color.ToUInt());
+}
+
+void VertexAttributeWriter::Commit()
+{
+    if (dirtyMin_ > dirtyMax_ || !vbuffer_)
+    {
+        return;
+    }
+
+    URHO3D_PROFILE(VertexAttributeCommit);
+
+    unsigned count = dirtyMax_ - dirtyMin_ + 1;
+    vbuffer_->SetDataRange(&shadowData_[dirtyMin_ * vertexSize_], dirtyMin_, count);
+    numUploadedVertices_ += count;
+
+    dirtyMin_ = M_MAX_UNSIGNED;
+    dirtyMax_ = 0;
+}
+
+void VertexAttributeWriter::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
+{
+    Commit();
+}
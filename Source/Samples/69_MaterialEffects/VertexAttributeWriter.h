@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Graphics/GraphicsDefs.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+// writes vertex attributes into a cpu copy of a vertex buffer and uploads
+// only the dirty vertex range, once per frame at render update
+//=============================================================================
+class VertexAttributeWriter : public Object
+{
+    URHO3D_OBJECT(VertexAttributeWriter, Object);
+
+public:
+    VertexAttributeWriter(Context *context);
+    virtual ~VertexAttributeWriter(){}
+
+    /// Take a cpu copy of a shadowed vertex buffer.
+    bool SetBuffer(VertexBuffer *vbuffer);
+    VertexBuffer* GetBuffer() const { return vbuffer_; }
+
+    /// Return offset of an element from the buffer's declared layout, M_MAX_UNSIGNED if not present.
+    unsigned GetElementOffset(VertexElementSemantic semantic, unsigned char index = 0) const;
+
+    void SetElement(unsigned vertex, unsigned offset, const void *data, unsigned size);
+    void SetColor(unsigned vertex, unsigned color);
+    void SetColor(unsigned vertex, const Color &color);
+
+    /// Upload the dirty range now, normally done at render update.
+    void Commit();
+
+    unsigned GetNumVertices() const { return numVertices_; }
+    unsigned GetNumUploadedVertices() const { return numUploadedVertices_; }
+
+protected:
+    void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
+
+protected:
+    WeakPtr<VertexBuffer>  vbuffer_;
+    PODVector<unsigned char> shadowData_;
+    unsigned               vertexSize_;
+    unsigned               numVertices_;
+    unsigned               colorOffset_;
+
+    // dirty vertex range, [dirtyMin_, dirtyMax_]
+    unsigned               dirtyMin_;
+    unsigned               dirtyMax_;
+
+    // stats
+    unsigned               numUploadedVertices_;
+};
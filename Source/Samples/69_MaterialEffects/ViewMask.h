@@ -0,0 +1,43 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+//=============================================================================
+// drawables default to all bits set, clearing a layer bit drops it from
+// every camera that only looks at that layer
+//=============================================================================
+enum ViewMaskLayerType
+{
+    ViewLayer_Reflects  = (0x40000000), // seen by reflection cameras
+    ViewLayer_Water     = (0x80000000), // water surfaces
+
+    ViewLayer_All       = (0xffffffff)
+};
+
+enum ViewMaskType
+{
+    ViewMask_Main       = ViewLayer_All,
+    ViewMask_Reflection = ViewLayer_Reflects,
+    ViewMask_Water      = ViewLayer_Water,
+};
@@ -0,0 +1,552 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/RenderSurface.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/Graphics/Viewport.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include "ReflectionTargetPool.h"
+#include "ViewMask.h"
+#include "WaterReflection.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+static const int levelSizes[WaterReflLevel_MAX] = { 256, 512, 1024 };
+
+// coverage (fraction of the screen) at which the next level up is wanted,
+// and the margin the coverage must drop below it before stepping back down
+static const float levelCoverage[WaterReflLevel_MAX] = { 0.0f, 0.08f, 0.30f };
+static const float coverageMargin = 0.03f;
+
+// seconds a new level has to be requested before it's switched to
+static const float levelHoldTime = 0.5f;
+
+// the budget cap engages above budget * overBudgetScale and lifts only below budget * underBudgetScale,
+// a budget of exactly the vsync period would flip the cap every few frames otherwise
+static const float overBudgetScale = 1.1f;
+static const float underBudgetScale = 0.9f;
+
+//=============================================================================
+//=============================================================================
+WaterReflection::WaterReflection(Context *context)
+    : Object(context)
+    , curLevel_(WaterReflLevel_1024)
+    , maxLevel_(WaterReflLevel_1024)
+    , updateInterval_(1)
+    , framesSinceUpdate_(0)
+    , moveThreshold_(0.5f)
+    , turnThreshold_(4.0f)
+    , lightsDirty_(false)
+    , forceUpdate_(true)
+    , pendingLevel_(WaterReflLevel_1024)
+    , pendingTime_(0.0f)
+    , frameBudgetMSec_(0.0f)
+    , avgFrameMSec_(0.0f)
+    , overBudget_(false)
+    , updating_(false)
+    , beginBatches_(0)
+    , beginPrimitives_(0)
+    , frameBatches_(0)
+    , framePrimitives_(0)
+    , numBatches_(0)
+    , numPrimitives_(0)
+    , totalBatches_(0)
+    , totalPrimitives_(0)
+{
+}
+
+WaterReflection::~WaterReflection()
+{
+    if (pool_)
+    {
+        pool_->Release(target_);
+    }
+
+    if (reflectionCameraNode_)
+    {
+        reflectionCameraNode_->Remove();
+    }
+}
+
+bool WaterReflection::Init(Scene *scene, Node *cameraNode, const Plane &waterPlane, ReflectionTargetPool *pool)
+{
+    if (!scene || !cameraNode || !pool)
+    {
+        return false;
+    }
+
+    Graphics* graphics = GetSubsystem<Graphics>();
+
+    scene_ = scene;
+    cameraNode_ = cameraNode;
+    camera_ = cameraNode->GetComponent<Camera>();
+    pool_ = pool;
+
+    waterPlane_ = waterPlane;
+    waterClipPlane_ = Plane(waterPlane.normal_, -waterPlane.normal_ * (waterPlane.d_ + 0.1f));
+
+    reflectionCameraNode_ = cameraNode->CreateChild();
+    Camera* reflectionCamera = reflectionCameraNode_->CreateComponent<Camera>();
+    reflectionCamera_ = reflectionCamera;
+    reflectionCamera->SetViewMask(ViewMask_Reflection); // only drawables and lights in the reflects layer
+    reflectionCamera->SetAutoAspectRatio(false);
+    reflectionCamera->SetUseReflection(true);
+    reflectionCamera->SetReflectionPlane(waterPlane_);
+    reflectionCamera->SetUseClipping(true); // Enable clipping of geometry behind water plane
+    reflectionCamera->SetClipPlane(waterClipPlane_);
+    reflectionCamera->SetAspectRatio((float)graphics->GetWidth() / (float)graphics->GetHeight());
+
+    viewport_ = new Viewport(context_, scene_, reflectionCamera);
+    SetTargetLevel(curLevel_);
+
+    SetPolicy(policy_);
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WaterReflection, HandleBeginFrame));
+    SubscribeToEvent(E_BEGINVIEWRENDER, URHO3D_HANDLER(WaterReflection, HandleBeginViewRender));
+    SubscribeToEvent(E_ENDVIEWRENDER, URHO3D_HANDLER(WaterReflection, HandleEndViewRender));
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(WaterReflection, HandleEndRendering));
+    SubscribeToEvent(scene_, E_COMPONENTADDED, URHO3D_HANDLER(WaterReflection, HandleComponentAdded));
+
+    return true;
+}
+
+void WaterReflection::AddSurface(StaticModel *waterModel)
+{
+    if (!waterModel)
+    {
+        return;
+    }
+
+    waterModel->SetViewMask(ViewMask_Water);
+    waterDrawables_.Push(WeakPtr<Drawable>(waterModel));
+
+    Material *material = waterModel->GetMaterial();
+    if (material && !waterMats_.Contains(WeakPtr<Material>(material)))
+    {
+        waterMats_.Push(WeakPtr<Material>(material));
+        BindTarget(material);
+    }
+
+    forceUpdate_ = true;
+}
+
+void WaterReflection::BindTarget(Material *material)
+{
+    material->SetTexture(TU_SPECULAR, target_);
+
+    if (camera_)
+    {
+        material->SetShaderParameter("ReflViewProj", camera_->GetGPUProjection() * camera_->GetView());
+    }
+}
+
+void WaterReflection::SetTargetLevel(int level)
+{
+    curLevel_ = level;
+
+    if (target_ && target_->GetWidth() == levelSizes[level])
+    {
+        return;
+    }
+
+    pool_->Release(target_);
+    target_ = pool_->Acquire(levelSizes[level]);
+    target_->GetRenderSurface()->SetViewport(0, viewport_);
+
+    for ( unsigned i = 0; i < waterMats_.Size(); ++i )
+    {
+        if (waterMats_[i])
+        {
+            waterMats_[i]->SetTexture(TU_SPECULAR, target_);
+        }
+    }
+
+    forceUpdate_ = true;
+}
+
+void WaterReflection::SetMotionThreshold(float distance, float angleDeg)
+{
+    moveThreshold_ = distance;
+    turnThreshold_ = angleDeg;
+}
+
+bool WaterReflection::NeedsUpdate() const
+{
+    if (forceUpdate_ || updateInterval_ <= 1 || framesSinceUpdate_ + 1 >= updateInterval_)
+    {
+        return true;
+    }
+
+    Vector3 cameraPos = cameraNode_->GetWorldPosition();
+    Quaternion cameraRot = cameraNode_->GetWorldRotation();
+
+    // angle between the current and last rendered view directions
+    float cosAngle = (cameraRot * Vector3::FORWARD).DotProduct(lastCameraRot_ * Vector3::FORWARD);
+
+    return (cameraPos - lastCameraPos_).Length() > moveThreshold_ ||
+           cosAngle < Cos(turnThreshold_);
+}
+
+void WaterReflection::SetPolicy(const WaterReflectionPolicy &policy)
+{
+    policy_ = policy;
+
+    ApplyPolicy();
+    AssignReflectLayer();
+}
+
+void WaterReflection::ApplyPolicy()
+{
+    if (!reflectionCamera_)
+    {
+        return;
+    }
+
+    reflectionCamera_->SetFarClip(policy_.farClip_);
+    reflectionCamera_->SetLodBias(policy_.lodBias_);
+    reflectionCamera_->SetViewOverrideFlags(policy_.shadows_ ? VO_NONE : VO_DISABLE_SHADOWS);
+}
+
+static bool CompareReflectLights(Light *lhs, Light *rhs)
+{
+    if (lhs->GetLightType() != rhs->GetLightType())
+    {
+        return lhs->GetLightType() == LIGHT_DIRECTIONAL;
+    }
+
+    return lhs->GetRange() * lhs->GetBrightness() > rhs->GetRange() * rhs->GetBrightness();
+}
+
+void WaterReflection::AssignReflectLayer()
+{
+    addedDrawables_.Clear();
+    lightsDirty_ = false;
+
+    if (!scene_)
+    {
+        return;
+    }
+
+    PODVector<Drawable*> drawables;
+    PODVector<Light*> lights;
+    scene_->GetDerivedComponents<Drawable>(drawables, true);
+
+    for ( unsigned i = 0; i < drawables.Size(); ++i )
+    {
+        Drawable *drawable = drawables[i];
+
+        if (drawable->GetDrawableFlags() & DRAWABLE_LIGHT)
+        {
+            lights.Push(static_cast<Light*>(drawable));
+            continue;
+        }
+
+        AssignDrawableLayer(drawable);
+    }
+
+    AssignLightLayer(lights);
+}
+
+void WaterReflection::AssignDrawableLayer(Drawable *drawable)
+{
+    unsigned viewMask = drawable->GetViewMask();
+
+    // water surfaces, zones and other non-geometry keep their mask
+    if (viewMask == ViewMask_Water || !(drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY))
+    {
+        return;
+    }
+
+    // bounds that are not set up yet (no model, or a node not positioned yet) count as reflecting
+    const BoundingBox &box = drawable->GetWorldBoundingBox();
+    bool sized = !box.Defined() || box.Size() == Vector3::ZERO || box.Size().Length() >= policy_.minReflectSize_;
+    bool reflects = !drawable->GetNode()->HasTag("noreflect") && sized;
+
+    drawable->SetViewMask(reflects ? (viewMask | ViewLayer_Reflects) : (viewMask & ~ViewLayer_Reflects));
+}
+
+void WaterReflection::AssignLightLayer(PODVector<Light*> &lights)
+{
+    // light cap for the reflection pass
+    Sort(lights.Begin(), lights.End(), CompareReflectLights);
+
+    for ( unsigned i = 0; i < lights.Size(); ++i )
+    {
+        unsigned viewMask = lights[i]->GetViewMask();
+        lights[i]->SetViewMask(i < policy_.maxLights_ ? (viewMask | ViewLayer_Reflects) : (viewMask & ~ViewLayer_Reflects));
+    }
+}
+
+float WaterReflection::GetBatchShare() const
+{
+    return totalBatches_ ? (float)numBatches_ / (float)totalBatches_ : 0.0f;
+}
+
+float WaterReflection::GetPrimitiveShare() const
+{
+    return totalPrimitives_ ? (float)numPrimitives_ / (float)totalPrimitives_ : 0.0f;
+}
+
+int WaterReflection::GetTextureSize() const
+{
+    return levelSizes[curLevel_];
+}
+
+void WaterReflection::SetMaxLevel(int level)
+{
+    maxLevel_ = Clamp(level, 0, (int)WaterReflLevel_MAX - 1);
+}
+
+float WaterReflection::GetScreenCoverage(Camera *camera, const BoundingBox &box) const
+{
+    const Matrix4 viewProj = camera->GetProjection() * camera->GetView();
+    Rect screenRect;
+
+    for ( unsigned i = 0; i < 8; ++i )
+    {
+        Vector3 corner((i & 1) ? box.max_.x_ : box.min_.x_,
+                       (i & 2) ? box.max_.y_ : box.min_.y_,
+                       (i & 4) ? box.max_.z_ : box.min_.z_);
+        Vector4 clipPos = viewProj * Vector4(corner, 1.0f);
+
+        // a corner behind the camera means the plane extends past the screen edges
+        if (clipPos.w_ <= camera->GetNearClip())
+        {
+            return 1.0f;
+        }
+
+        screenRect.Merge(Vector2(clipPos.x_ / clipPos.w_, clipPos.y_ / clipPos.w_));
+    }
+
+    // clip to the screen, ndc spans 2x2
+    float width = Clamp(screenRect.max_.x_, -1.0f, 1.0f) - Clamp(screenRect.min_.x_, -1.0f, 1.0f);
+    float height = Clamp(screenRect.max_.y_, -1.0f, 1.0f) - Clamp(screenRect.min_.y_, -1.0f, 1.0f);
+
+    return width * height * 0.25f;
+}
+
+int WaterReflection::GetDesiredLevel(float coverage) const
+{
+    int level = curLevel_;
+
+    // step up as soon as the threshold is crossed, step down only past the margin
+    while (level < WaterReflLevel_MAX - 1 && coverage >= levelCoverage[level + 1])
+    {
+        ++level;
+    }
+    while (level > 0 && coverage < levelCoverage[level] - coverageMargin)
+    {
+        --level;
+    }
+
+    int maxLevel = maxLevel_;
+    if (frameBudgetMSec_ > 0.0f && overBudget_)
+    {
+        maxLevel = Max(maxLevel - 1, 0);
+    }
+
+    return Min(level, maxLevel);
+}
+
+void WaterReflection::Update(float timeStep)
+{
+    updating_ = false;
+
+    if (!reflectionCamera_ || !camera_)
+    {
+        return;
+    }
+
+    // components added since the last update, only lights need the others to rank against
+    if (lightsDirty_ && scene_)
+    {
+        PODVector<Light*> lights;
+        scene_->GetComponents<Light>(lights, true);
+        AssignLightLayer(lights);
+        lightsDirty_ = false;
+    }
+
+    for ( unsigned i = 0; i < addedDrawables_.Size(); ++i )
+    {
+        if (addedDrawables_[i])
+        {
+            AssignDrawableLayer(addedDrawables_[i]);
+        }
+    }
+    addedDrawables_.Clear();
+
+    Graphics* graphics = GetSubsystem<Graphics>();
+
+    if (!overBudget_ && avgFrameMSec_ > frameBudgetMSec_ * overBudgetScale)
+    {
+        overBudget_ = true;
+    }
+    else if (overBudget_ && avgFrameMSec_ < frameBudgetMSec_ * underBudgetScale)
+    {
+        overBudget_ = false;
+    }
+
+    // In case resolution has changed, adjust the reflection camera aspect ratio
+    reflectionCamera_->SetAspectRatio((float)graphics->GetWidth() / (float)graphics->GetHeight());
+
+    // skip the reflection pass entirely when none of the surfaces can be seen
+    const Frustum &frustum = camera_->GetFrustum();
+    float coverage = 0.0f;
+    bool inView = false;
+
+    for ( unsigned i = 0; i < waterDrawables_.Size(); ++i )
+    {
+        Drawable *drawable = waterDrawables_[i];
+
+        if (drawable && drawable->IsEnabledEffective() && frustum.IsInsideFast(drawable->GetWorldBoundingBox()) != OUTSIDE)
+        {
+            coverage += GetScreenCoverage(camera_, drawable->GetWorldBoundingBox());
+            inView = true;
+        }
+    }
+
+    if (!inView)
+    {
+        forceUpdate_ = true;
+        return;
+    }
+
+    int desiredLevel = GetDesiredLevel(Min(coverage, 1.0f));
+
+    if (desiredLevel != pendingLevel_)
+    {
+        pendingLevel_ = desiredLevel;
+        pendingTime_ = 0.0f;
+    }
+    else if (pendingLevel_ != curLevel_)
+    {
+        pendingTime_ += timeStep;
+
+        if (pendingTime_ >= levelHoldTime)
+        {
+            SetTargetLevel(pendingLevel_);
+        }
+    }
+
+    if (!NeedsUpdate())
+    {
+        ++framesSinceUpdate_;
+        return;
+    }
+
+    target_->GetRenderSurface()->QueueUpdate();
+    updating_ = true;
+
+    // the water shader reprojects through this until the next update
+    for ( unsigned i = 0; i < waterMats_.Size(); ++i )
+    {
+        if (waterMats_[i])
+        {
+            BindTarget(waterMats_[i]);
+        }
+    }
+
+    lastCameraPos_ = cameraNode_->GetWorldPosition();
+    lastCameraRot_ = cameraNode_->GetWorldRotation();
+    framesSinceUpdate_ = 0;
+    forceUpdate_ = false;
+}
+
+void WaterReflection::HandleBeginViewRender(StringHash eventType, VariantMap& eventData)
+{
+    using namespace BeginViewRender;
+
+    if (eventData[P_CAMERA].GetPtr() == reflectionCamera_.Get())
+    {
+        Graphics* graphics = GetSubsystem<Graphics>();
+        beginBatches_ = graphics->GetNumBatches();
+        beginPrimitives_ = graphics->GetNumPrimitives();
+    }
+}
+
+void WaterReflection::HandleEndViewRender(StringHash eventType, VariantMap& eventData)
+{
+    using namespace EndViewRender;
+
+    if (eventData[P_CAMERA].GetPtr() == reflectionCamera_.Get())
+    {
+        Graphics* graphics = GetSubsystem<Graphics>();
+        frameBatches_ += graphics->GetNumBatches() - beginBatches_;
+        framePrimitives_ += graphics->GetNumPrimitives() - beginPrimitives_;
+    }
+}
+
+void WaterReflection::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    frameTimer_.Reset();
+}
+
+void WaterReflection::HandleEndRendering(StringHash eventType, VariantMap& eventData)
+{
+    Graphics* graphics = GetSubsystem<Graphics>();
+
+    // update and render work of the frame, the present and the frame limiter's wait are not included
+    avgFrameMSec_ = Lerp(avgFrameMSec_, (float)frameTimer_.GetUSec(false) / 1000.0f, 0.1f);
+
+    numBatches_ = frameBatches_;
+    numPrimitives_ = framePrimitives_;
+    totalBatches_ = graphics->GetNumBatches();
+    totalPrimitives_ = graphics->GetNumPrimitives();
+
+    frameBatches_ = 0;
+    framePrimitives_ = 0;
+}
+
+void WaterReflection::HandleComponentAdded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ComponentAdded;
+
+    Component *component = static_cast<Component*>(eventData[P_COMPONENT].GetPtr());
+
+    // the model and transform are usually set after the component is created, assign on the next update
+    if (!component)
+    {
+        return;
+    }
+
+    if (component->IsInstanceOf<Light>())
+    {
+        lightsDirty_ = true;
+    }
+    else if (component->IsInstanceOf<Drawable>())
+    {
+        addedDrawables_.Push(WeakPtr<Drawable>(static_cast<Drawable*>(component)));
+    }
+}
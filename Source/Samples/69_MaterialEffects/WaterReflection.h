@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Math/Plane.h>
+
+using namespace Urho3D;
+
+namespace Urho3D
+{
+class Camera;
+class Drawable;
+class Light;
+class Material;
+class Node;
+class Scene;
+class StaticModel;
+class Texture2D;
+class Viewport;
+}
+
+class ReflectionTargetPool;
+
+//=============================================================================
+//=============================================================================
+enum WaterReflectionLevel
+{
+    WaterReflLevel_256,     // 0
+    WaterReflLevel_512,     // 1
+    WaterReflLevel_1024,    // 2
+    WaterReflLevel_MAX,
+};
+
+// reflection pass limits, everything outside them is left to the main view
+struct WaterReflectionPolicy
+{
+    WaterReflectionPolicy()
+        : farClip_(150.0f)
+        , lodBias_(0.5f)
+        , shadows_(false)
+        , maxLights_(2)
+        , minReflectSize_(0.5f)
+    {
+    }
+
+    float    farClip_;
+    float    lodBias_;
+    bool     shadows_;
+    /// Lights beyond this count (directional first, then by range) lose the reflects layer.
+    unsigned maxLights_;
+    /// Drawables with a smaller bounding box diagonal lose the reflects layer, as do nodes tagged "noreflect".
+    float    minReflectSize_;
+};
+
+//=============================================================================
+// planar reflection shared by the water surfaces lying on one plane, the render
+// target size follows their projected screen coverage and nothing is rendered
+// while none of them are in view
+//=============================================================================
+class WaterReflection : public Object
+{
+    URHO3D_OBJECT(WaterReflection, Object);
+
+public:
+    WaterReflection(Context *context);
+    virtual ~WaterReflection();
+
+    /// Create the reflection camera for a plane under the view camera node, targets come from the pool.
+    bool Init(Scene *scene, Node *cameraNode, const Plane &waterPlane, ReflectionTargetPool *pool);
+    /// Add a water surface on the plane, its material gets the reflection bound.
+    void AddSurface(StaticModel *waterModel);
+    /// Call after the view camera has been moved for the frame.
+    void Update(float timeStep);
+
+    /// Frame work time (update and render on the cpu, without present or frame limiting) above which the reflection
+    /// resolution is capped one level lower, with a margin either side of it. 0 disables.
+    void SetFrameBudget(float msec) { frameBudgetMSec_ = msec; }
+    void SetMaxLevel(int level);
+    /// Apply reflection camera limits and assign the reflects view layer to the scene's drawables and lights.
+    /// Drawables and lights added to the scene later are assigned on the next Update.
+    void SetPolicy(const WaterReflectionPolicy &policy);
+    const WaterReflectionPolicy& GetPolicy() const { return policy_; }
+    /// Re-render the reflection every interval frames, or sooner when the camera moves or turns past the thresholds.
+    /// In between, the water shader reprojects the stale reflection with the view-projection it was rendered with.
+    void SetUpdateInterval(unsigned frames) { updateInterval_ = Max(frames, 1U); }
+    void SetMotionThreshold(float distance, float angleDeg);
+
+    Camera* GetReflectionCamera() const { return reflectionCamera_; }
+    const Plane& GetPlane() const { return waterPlane_; }
+    unsigned GetNumSurfaces() const { return waterDrawables_.Size(); }
+    int GetTextureSize() const;
+    bool IsUpdating() const { return updating_; }
+
+    /// Reflection pass stats of the last rendered frame.
+    unsigned GetNumBatches() const { return numBatches_; }
+    unsigned GetNumPrimitives() const { return numPrimitives_; }
+    /// Reflection pass share of the whole frame's batches and primitives, 0-1.
+    float GetBatchShare() const;
+    float GetPrimitiveShare() const;
+
+protected:
+    void SetTargetLevel(int level);
+    void BindTarget(Material *material);
+    float GetScreenCoverage(Camera *camera, const BoundingBox &box) const;
+    int GetDesiredLevel(float coverage) const;
+    bool NeedsUpdate() const;
+    void ApplyPolicy();
+    void AssignReflectLayer();
+    void AssignDrawableLayer(Drawable *drawable);
+    void AssignLightLayer(PODVector<Light*> &lights);
+
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    void HandleBeginViewRender(StringHash eventType, VariantMap& eventData);
+    void HandleEndViewRender(StringHash eventType, VariantMap& eventData);
+    void HandleEndRendering(StringHash eventType, VariantMap& eventData);
+    void HandleComponentAdded(StringHash eventType, VariantMap& eventData);
+
+protected:
+    WeakPtr<Scene>          scene_;
+    WeakPtr<Node>           cameraNode_;
+    WeakPtr<Camera>         camera_;
+    Vector<WeakPtr<Drawable> > waterDrawables_;
+    Vector<WeakPtr<Material> > waterMats_;
+
+    SharedPtr<Node>         reflectionCameraNode_;
+    WeakPtr<Camera>         reflectionCamera_;
+    Plane                   waterPlane_;
+    Plane                   waterClipPlane_;
+    WaterReflectionPolicy   policy_;
+    // added since the last update
+    Vector<WeakPtr<Drawable> > addedDrawables_;
+    bool                    lightsDirty_;
+
+    SharedPtr<ReflectionTargetPool> pool_;
+    SharedPtr<Texture2D>    target_;
+    SharedPtr<Viewport>     viewport_;
+    int                     curLevel_;
+    int                     maxLevel_;
+
+    // time slicing
+    unsigned                updateInterval_;
+    unsigned                framesSinceUpdate_;
+    float                   moveThreshold_;
+    float                   turnThreshold_;
+    Vector3                 lastCameraPos_;
+    Quaternion              lastCameraRot_;
+    bool                    forceUpdate_;
+
+    // hysteresis
+    int                     pendingLevel_;
+    float                   pendingTime_;
+
+    float                   frameBudgetMSec_;
+    float                   avgFrameMSec_;
+    bool                    overBudget_;
+    HiresTimer              frameTimer_;
+    bool                    updating_;
+
+    // stats
+    unsigned                beginBatches_;
+    unsigned                beginPrimitives_;
+    unsigned                frameBatches_;
+    unsigned                framePrimitives_;
+    unsigned                numBatches_;
+    unsigned                numPrimitives_;
+    unsigned                totalBatches_;
+    unsigned                totalPrimitives_;
+};
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Technique.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "ReflectionTargetPool.h"
+#include "WaterSurfaceManager.h"
+
+#include <Urho3D/DebugNew.h>
+//=============================================================================
+//=============================================================================
+WaterSurfaceManager::WaterSurfaceManager(Context *context)
+    : Object(context)
+    , normalTolerance_(Cos(2.0f))
+    , distanceTolerance_(0.05f)
+    , frameBudgetMSec_(0.0f)
+    , updateInterval_(1)
+    , moveThreshold_(0.5f)
+    , turnThreshold_(4.0f)
+    , lowQuality_(false)
+{
+}
+
+void WaterSurfaceManager::Init(Scene *scene, Node *cameraNode)
+{
+    scene_ = scene;
+    cameraNode_ = cameraNode;
+    pool_ = new ReflectionTargetPool(context_);
+    reflections_.Clear();
+    materialGroups_.Clear();
+}
+
+void WaterSurfaceManager::SetPlaneTolerance(float angleDeg, float distance)
+{
+    normalTolerance_ = Cos(angleDeg);
+    distanceTolerance_ = distance;
+}
+
+unsigned WaterSurfaceManager::FindGroup(const Plane &plane) const
+{
+    for ( unsigned i = 0; i < reflections_.Size(); ++i )
+    {
+        const Plane &groupPlane = reflections_[i]->GetPlane();
+
+        if (groupPlane.normal_.DotProduct(plane.normal_) >= normalTolerance_ &&
+            Abs(groupPlane.d_ - plane.d_) <= distanceTolerance_)
+        {
+            return i;
+        }
+    }
+
+    return M_MAX_UNSIGNED;
+}
+
+unsigned WaterSurfaceManager::AddSurface(Node *waterNode)
+{
+    StaticModel *waterModel = waterNode ? waterNode->GetComponent<StaticModel>() : NULL;
+
+    if (!waterModel || !pool_)
+    {
+        return M_MAX_UNSIGNED;
+    }
+
+    Plane plane(waterNode->GetWorldRotation() * Vector3::UP, waterNode->GetWorldPosition());
+    unsigned group = FindGroup(plane);
+
+    if (group == M_MAX_UNSIGNED)
+    {
+        SharedPtr<WaterReflection> reflection(new WaterReflection(context_));
+        if (!reflection->Init(scene_, cameraNode_, plane, pool_))
+        {
+            return M_MAX_UNSIGNED;
+        }
+
+        ApplySettings(reflection);
+        group = reflections_.Size();
+        reflections_.Push(reflection);
+    }
+
+    // a material can only show one reflection, surfaces on another plane get their own copy
+    Material *material = waterModel->GetMaterial();
+    if (material)
+    {
+        HashMap<Material*, unsigned>::Iterator itr = materialGroups_.Find(material);
+
+        if (itr != materialGroups_.End() && itr->second_ != group)
+        {
+            SharedPtr<Material> clone = material->Clone();
+            waterModel->SetMaterial(clone);
+            material = clone;
+        }
+        materialGroups_[material] = group;
+        ApplyQuality(material);
+    }
+
+    reflections_[group]->AddSurface(waterModel);
+
+    return group;
+}
+
+unsigned WaterSurfaceManager::AddTaggedSurfaces(const String &tag)
+{
+    if (!scene_)
+    {
+        return 0;
+    }
+
+    PODVector<Node*> nodes;
+    scene_->GetChildrenWithTag(nodes, tag, true);
+    unsigned numAdded = 0;
+
+    for ( unsigned i = 0; i < nodes.Size(); ++i )
+    {
+        if (AddSurface(nodes[i]) != M_MAX_UNSIGNED)
+        {
+            ++numAdded;
+        }
+    }
+
+    return numAdded;
+}
+
+unsigned WaterSurfaceManager::GetNumSurfaces() const
+{
+    unsigned numSurfaces = 0;
+
+    for ( unsigned i = 0; i < reflections_.Size(); ++i )
+    {
+        numSurfaces += reflections_[i]->GetNumSurfaces();
+    }
+
+    return numSurfaces;
+}
+
+void WaterSurfaceManager::ApplySettings(WaterReflection *reflection)
+{
+    reflection->SetPolicy(policy_);
+    reflection->SetFrameBudget(frameBudgetMSec_);
+    reflection->SetUpdateInterval(updateInterval_);
+    reflection->SetMotionThreshold(moveThreshold_, turnThreshold_);
+}
+
+void WaterSurfaceManager::SetPolicy(const WaterReflectionPolicy &policy)
+{
+    policy_ = policy;
+
+    for ( unsigned i = 0; i < reflections_.Size(); ++i )
+    {
+        reflections_[i]->SetPolicy(policy_);
+    }
+}
+
+void WaterSurfaceManager::SetFrameBudget(float msec)
+{
+    frameBudgetMSec_ = msec;
+
+    for ( unsigned i = 0; i < reflections_.Size(); ++i )
+    {
+        reflections_[i]->SetFrameBudget(frameBudgetMSec_);
+    }
+}
+
+void WaterSurfaceManager::SetUpdateInterval(unsigned frames)
+{
+    updateInterval_ = frames;
+
+    for ( unsigned i = 0; i < reflections_.Size(); ++i )
+    {
+        reflections_[i]->SetUpdateInterval(updateInterval_);
+    }
+}
+
+void WaterSurfaceManager::SetMotionThreshold(float distance, float angleDeg)
+{
+    moveThreshold_ = distance;
+    turnThreshold_ = angleDeg;
+
+    for ( unsigned i = 0; i < reflections_.Size(); ++i )
+    {
+        reflections_[i]->SetMotionThreshold(moveThreshold_, turnThreshold_);
+    }
+}
+
+void WaterSurfaceManager::SetLowQuality(bool lowQuality)
+{
+    lowQuality_ = lowQuality;
+
+    for ( HashMap<Material*, unsigned>::ConstIterator itr = materialGroups_.Begin(); itr != materialGroups_.End(); ++itr )
+    {
+        ApplyQuality(itr->first_);
+    }
+}
+
+void WaterSurfaceManager::ApplyQuality(Material *material)
+{
+    ResourceCache *cache = GetSubsystem<ResourceCache>();
+
+    // only the near entry is swapped, the loddistance entry already draws distant water low
+    for ( unsigned i = 0; i < material->GetNumTechniques(); ++i )
+    {
+        const TechniqueEntry &entry = material->GetTechniqueEntry(i);
+
+        if (!entry.original_ || entry.lodDistance_ > 0.0f)
+        {
+            continue;
+        }
+
+        String name = entry.original_->GetName();
+        bool isLow = name.EndsWith("Low.xml");
+
+        if (isLow == lowQuality_)
+        {
+            continue;
+        }
+
+        String swapName = isLow ? name.Substring(0, name.Length() - 7) + ".xml" : name.Substring(0, name.Length() - 4) + "Low.xml";
+        Technique *technique = cache->GetResource<Technique>(swapName);
+
+        if (technique)
+        {
+            material->SetTechnique(i, technique, entry.qualityLevel_, entry.lodDistance_);
+        }
+    }
+}
+
+void WaterSurfaceManager::Update(float timeStep)
+{
+    for ( unsigned i = 0; i < reflections_.Size(); ++i )
+    {
+        reflections_[i]->Update(timeStep);
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+
+#include "WaterReflection.h"
+
+using namespace Urho3D;
+
+class ReflectionTargetPool;
+
+//=============================================================================
+// groups water surfaces that lie on (nearly) the same plane into one shared
+// reflection, reflection cost grows with distinct planes, not water meshes
+//=============================================================================
+class WaterSurfaceManager : public Object
+{
+    URHO3D_OBJECT(WaterSurfaceManager, Object);
+
+public:
+    WaterSurfaceManager(Context *context);
+    virtual ~WaterSurfaceManager(){}
+
+    void Init(Scene *scene, Node *cameraNode);
+    /// Add the StaticModel of a node as a water surface, returns the reflection group index or M_MAX_UNSIGNED.
+    unsigned AddSurface(Node *waterNode);
+    /// Add every node carrying the tag, returns the number added.
+    unsigned AddTaggedSurfaces(const String &tag);
+    void Update(float timeStep);
+
+    /// Plane grouping tolerances, the angle between normals and the distance between planes.
+    void SetPlaneTolerance(float angleDeg, float distance);
+
+    // settings applied to every group
+    void SetPolicy(const WaterReflectionPolicy &policy);
+    void SetFrameBudget(float msec);
+    void SetUpdateInterval(unsigned frames);
+    void SetMotionThreshold(float distance, float angleDeg);
+    /// Draw near water with the "Low" variant of its technique, touches only the water materials.
+    void SetLowQuality(bool lowQuality);
+    bool GetLowQuality() const { return lowQuality_; }
+
+    unsigned GetNumReflections() const { return reflections_.Size(); }
+    WaterReflection* GetReflection(unsigned index) const { return index < reflections_.Size() ? reflections_[index] : (WaterReflection*)NULL; }
+    unsigned GetNumSurfaces() const;
+    ReflectionTargetPool* GetTargetPool() const { return pool_; }
+
+protected:
+    unsigned FindGroup(const Plane &plane) const;
+    void ApplySettings(WaterReflection *reflection);
+    void ApplyQuality(Material *material);
+
+protected:
+    WeakPtr<Scene>                      scene_;
+    WeakPtr<Node>                       cameraNode_;
+    SharedPtr<ReflectionTargetPool>     pool_;
+    Vector<SharedPtr<WaterReflection> > reflections_;
+    // materials already bound to a group
+    HashMap<Material*, unsigned>        materialGroups_;
+
+    float                               normalTolerance_;
+    float                               distanceTolerance_;
+
+    WaterReflectionPolicy               policy_;
+    float                               frameBudgetMSec_;
+    unsigned                            updateInterval_;
+    float                               moveThreshold_;
+    float                               turnThreshold_;
+    bool                                lowQuality_;
+};
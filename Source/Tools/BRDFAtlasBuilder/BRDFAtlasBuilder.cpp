@@ -0,0 +1,414 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/XMLElement.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+//=============================================================================
+int main(int argc, char** argv);
+int Run(Vector<String>& arguments);
+
+struct RampInfo
+{
+    String           name_;
+    SharedPtr<Image> image_;
+    int              rowOffset_;
+};
+
+struct MaterialInfo
+{
+    String           file_;
+    unsigned         ramp_;
+};
+
+//=============================================================================
+//=============================================================================
+void Help(const String &message = String::EMPTY)
+{
+    if (!message.Empty())
+    {
+        PrintLine(message);
+    }
+
+    ErrorExit("BRDFAtlasBuilder, packs the BRDF ramps of the fake BRDF materials into one atlas\n"
+              "Usage: BRDFAtlasBuilder materialFolderPath -options\n\n"
+              "options:\n"
+              "-r resource folders that texture names resolve against, ';' separated, the atlas is written\n"
+              "   under the first (default = the folder two levels up, then the material folder parent)\n"
+              "-o atlas resource name, png (default = MaterialEffects/Textures/fakeBRDF/brdfAtlas.png)\n"
+              "-t technique name filter (default = FakeBRDF)\n"
+              "-n dry run, report the layout without writing the atlas or the materials\n"
+              "-v verbose output\n"
+              "-h shows this help message\n\n"
+              "Ramps are stacked vertically in the order they are first referenced and must share the same width,\n"
+              "the atlas gets the most components of any ramp.\n"
+              "Materials get the atlas as their emissive texture, the source ramp is kept in the texture's 'ramp'\n"
+              "attribute so the atlas can be rebuilt, the BRDFAtlasRow parameter and the BRDFATLAS ps define.\n");
+}
+
+//=============================================================================
+//=============================================================================
+bool LoadXML(Context *context, const String &path, XMLFile &xmlFile)
+{
+    File file(context, path, FILE_READ);
+    return file.IsOpen() && xmlFile.Load(file);
+}
+
+bool UsesTechnique(const XMLElement &materialElem, const String &filter)
+{
+    for ( XMLElement techElem = materialElem.GetChild("technique"); techElem; techElem = techElem.GetNext("technique") )
+    {
+        if (techElem.GetAttribute("name").Contains(filter, false))
+            return true;
+    }
+
+    return false;
+}
+
+XMLElement GetEmissiveTexture(const XMLElement &materialElem)
+{
+    for ( XMLElement texElem = materialElem.GetChild("texture"); texElem; texElem = texElem.GetNext("texture") )
+    {
+        if (texElem.GetAttribute("unit").ToLower() == "emissive")
+            return texElem;
+    }
+
+    return XMLElement();
+}
+
+// first root the name exists under, like the resource cache's resource dirs
+String ResolvePath(FileSystem *fileSystem, const Vector<String> &roots, const String &name)
+{
+    for ( unsigned i = 0; i < roots.Size(); ++i )
+    {
+        if (fileSystem->FileExists(roots[i] + name))
+        {
+            return roots[i] + name;
+        }
+    }
+
+    return String::EMPTY;
+}
+
+// adds the define once, keeps the others
+String AddDefine(const String &defines, const String &define)
+{
+    Vector<String> tokens = defines.Split(' ');
+
+    if (!tokens.Contains(define))
+        tokens.Push(define);
+
+    return String::Joined(tokens, " ");
+}
+
+//=============================================================================
+//=============================================================================
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+#ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+#else
+    arguments = ParseArguments(argc, argv);
+#endif
+
+    return Run(arguments);
+}
+
+int Run(Vector<String>& arguments)
+{
+    if (arguments.Size() < 1)
+    {
+        Help("Missing args, requires at least the material folder path\n");
+    }
+
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new Log(context));
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+
+    String materialPath = AddTrailingSlash(arguments[0]);
+    arguments.Erase(0);
+
+    String rootsArg;
+    String atlasName = "MaterialEffects/Textures/fakeBRDF/brdfAtlas.png";
+    String filter = "FakeBRDF";
+    bool dryRun = false;
+    bool verbose = false;
+
+    // parse args
+    while (arguments.Size() > 0)
+    {
+        String arg = arguments[0];
+        arguments.Erase(0);
+
+        if (arg.Empty())
+            continue;
+
+        if (arg.StartsWith("-"))
+        {
+                 if (arg == "-r" && arguments.Size()) { rootsArg = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-o" && arguments.Size()) { atlasName = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-t" && arguments.Size()) { filter = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-n") { dryRun = true; }
+            else if (arg == "-v") { verbose = true; }
+            else if (arg == "-h") { Help(); }
+            else { Help("Unknown option: " + arg); }
+        }
+        else
+        {
+            Help("Wrong arg order?");
+        }
+    }
+
+    if (!fileSystem->DirExists(materialPath))
+    {
+        ErrorExit("material folder not found: " + materialPath);
+    }
+
+    // materials name textures from the resource dir, bin/Data/MaterialEffects/Materials -> bin/Data/
+    Vector<String> roots;
+    if (rootsArg.Empty())
+    {
+        roots.Push(GetParentPath(GetParentPath(materialPath)));
+        roots.Push(GetParentPath(materialPath));
+    }
+    else
+    {
+        Vector<String> rootList = rootsArg.Split(';');
+        for ( unsigned i = 0; i < rootList.Size(); ++i )
+        {
+            roots.Push(AddTrailingSlash(rootList[i].Trimmed()));
+        }
+    }
+
+    Vector<String> materialFiles;
+    fileSystem->ScanDir(materialFiles, materialPath, "*.xml", SCAN_FILES, true);
+    Sort(materialFiles.Begin(), materialFiles.End());
+
+    Vector<RampInfo> ramps;
+    HashMap<String, unsigned> rampIndices;
+    Vector<MaterialInfo> materials;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    unsigned components = 0;
+
+    for ( unsigned i = 0; i < materialFiles.Size(); ++i )
+    {
+        XMLFile materialXML(context);
+
+        if (!LoadXML(context, materialPath + materialFiles[i], materialXML) || materialXML.GetRoot().GetName() != "material")
+        {
+            continue;
+        }
+
+        XMLElement materialElem = materialXML.GetRoot();
+        XMLElement texElem = GetEmissiveTexture(materialElem);
+
+        if (!UsesTechnique(materialElem, filter) || !texElem)
+        {
+            continue;
+        }
+
+        // already packed materials remember their source ramp
+        String rampName = texElem.HasAttribute("ramp") ? texElem.GetAttribute("ramp") : texElem.GetAttribute("name");
+        HashMap<String, unsigned>::Iterator itr = rampIndices.Find(rampName);
+
+        if (itr == rampIndices.End())
+        {
+            RampInfo ramp;
+            ramp.name_ = rampName;
+            ramp.image_ = new Image(context);
+            ramp.rowOffset_ = atlasHeight;
+
+            String rampPath = ResolvePath(fileSystem, roots, rampName);
+            if (rampPath.Empty())
+            {
+                ErrorExit("error: " + materialFiles[i] + " references missing ramp " + rampName);
+            }
+
+            File file(context, rampPath, FILE_READ);
+            if (!file.IsOpen() || !ramp.image_->Load(file))
+            {
+                ErrorExit("error: " + materialFiles[i] + " references unreadable ramp " + rampName);
+            }
+
+            components = Max(components, ramp.image_->GetComponents());
+
+            if (atlasWidth == 0)
+            {
+                atlasWidth = ramp.image_->GetWidth();
+            }
+            else if (atlasWidth != ramp.image_->GetWidth())
+            {
+                ErrorExit("error: ramp " + rampName + " width " + String(ramp.image_->GetWidth()) +
+                          " differs from " + String(atlasWidth));
+            }
+
+            atlasHeight += ramp.image_->GetHeight();
+            itr = rampIndices.Insert(MakePair(rampName, ramps.Size()));
+            ramps.Push(ramp);
+        }
+
+        MaterialInfo material;
+        material.file_ = materialFiles[i];
+        material.ramp_ = itr->second_;
+        materials.Push(material);
+    }
+
+    if (ramps.Empty())
+    {
+        ErrorExit("no materials using " + filter + " with an emissive ramp found");
+    }
+
+    // stack the ramps
+    SharedPtr<Image> atlas(new Image(context));
+    atlas->SetSize(atlasWidth, atlasHeight, Max(components, 3U));
+
+    for ( unsigned r = 0; r < ramps.Size(); ++r )
+    {
+        Image *image = ramps[r].image_;
+
+        for ( int y = 0; y < image->GetHeight(); ++y )
+        {
+            for ( int x = 0; x < image->GetWidth(); ++x )
+            {
+                atlas->SetPixelInt(x, ramps[r].rowOffset_ + y, image->GetPixelInt(x, y));
+            }
+        }
+
+        if (verbose)
+        {
+            PrintLine("row " + String(r) + ": " + ramps[r].name_ + ", offset " + String(ramps[r].rowOffset_) +
+                      ", height " + String(image->GetHeight()));
+        }
+    }
+
+    if (!dryRun)
+    {
+        String atlasFile = roots[0] + atlasName;
+
+        if (!atlas->SavePNG(atlasFile))
+        {
+            ErrorExit("failed to write " + atlasFile);
+        }
+
+        // rows are packed tight, clamp addressing like the source ramps and no mips to keep the rows apart
+        XMLFile texXML(context);
+        XMLElement texRoot = texXML.CreateRoot("texture");
+        XMLElement addressU = texRoot.CreateChild("address");
+        addressU.SetAttribute("coord", "u");
+        addressU.SetAttribute("mode", "clamp");
+        XMLElement addressV = texRoot.CreateChild("address");
+        addressV.SetAttribute("coord", "v");
+        addressV.SetAttribute("mode", "clamp");
+        XMLElement mipmap = texRoot.CreateChild("mipmap");
+        mipmap.SetBool("enable", false);
+
+        File texFile(context, ReplaceExtension(atlasFile, ".xml"), FILE_WRITE);
+        if (!texFile.IsOpen() || !texXML.Save(texFile, "    "))
+        {
+            ErrorExit("failed to write " + ReplaceExtension(atlasFile, ".xml"));
+        }
+    }
+
+    // point the materials at their row
+    for ( unsigned i = 0; i < materials.Size(); ++i )
+    {
+        const RampInfo &ramp = ramps[materials[i].ramp_];
+        float height = (float)atlasHeight;
+        Vector4 row((float)ramp.image_->GetHeight() / height,
+                    (float)ramp.rowOffset_ / height,
+                    ((float)ramp.rowOffset_ + 0.5f) / height,
+                    ((float)(ramp.rowOffset_ + ramp.image_->GetHeight()) - 0.5f) / height);
+
+        if (verbose)
+        {
+            PrintLine(materials[i].file_ + ": row " + String(materials[i].ramp_) + ", BRDFAtlasRow " + row.ToString());
+        }
+
+        if (dryRun)
+        {
+            continue;
+        }
+
+        XMLFile materialXML(context);
+        LoadXML(context, materialPath + materials[i].file_, materialXML);
+        XMLElement materialElem = materialXML.GetRoot();
+
+        XMLElement texElem = GetEmissiveTexture(materialElem);
+        texElem.SetAttribute("name", atlasName);
+        texElem.SetAttribute("ramp", ramp.name_);
+
+        XMLElement paramElem = materialElem.GetChild("parameter");
+        for ( ; paramElem; paramElem = paramElem.GetNext("parameter") )
+        {
+            if (paramElem.GetAttribute("name") == "BRDFAtlasRow")
+                break;
+        }
+        if (!paramElem)
+        {
+            paramElem = materialElem.CreateChild("parameter");
+            paramElem.SetAttribute("name", "BRDFAtlasRow");
+        }
+        paramElem.SetVector4("value", row);
+
+        XMLElement shaderElem = materialElem.GetChild("shader");
+        if (!shaderElem)
+        {
+            shaderElem = materialElem.CreateChild("shader");
+        }
+        shaderElem.SetAttribute("psdefines", AddDefine(shaderElem.GetAttribute("psdefines"), "BRDFATLAS"));
+
+        File file(context, materialPath + materials[i].file_, FILE_WRITE);
+        if (!file.IsOpen() || !materialXML.Save(file, "    "))
+        {
+            ErrorExit("failed to write " + materials[i].file_);
+        }
+    }
+
+    // report
+    PrintLine(String(materials.Size()) + " materials, " + String(ramps.Size()) + " ramps, atlas " +
+              String(atlasWidth) + "x" + String(atlasHeight) + (dryRun ? " (dry run)" : ", saved as " + atlasName));
+
+    return EXIT_SUCCESS;
+}
@@ -35,6 +35,8 @@
 #include <stdio.h>
 #endif
 
+#include "SequencePacker.h"
+
 #include <Urho3D/DebugNew.h>
 
 using namespace Urho3D;
@@ -44,28 +46,6 @@ using namespace Urho3D;
 int main(int argc, char** argv);
 void Run(Vector<String>& arguments);
 
-//=============================================================================
-//=============================================================================
-const char *getSequenceDecFormat(int idx, bool leadingZero)
-{
-    const char *dec1Format = "%1d";
-    const char *dec2Format = "%2d";
-    const char *dec3Format = "%3d";
-    const char *dec02Format = "%02d";
-    const char *dec03Format = "%03d";
-
-    if (idx == 1)
-    {
-        return dec1Format;
-    }
-    else if (idx == 2)
-    {
-        return leadingZero?dec02Format:dec2Format;
-    }
-
-    return leadingZero?dec03Format:dec3Format;
-}
-
 //=============================================================================
 //=============================================================================
 void Help(const String &message = String::EMPTY)
@@ -88,6 +68,9 @@ void Help(const String &message = String::EMPTY)
               "-ox x offset (default = 0)\n"
               "-oy y offset (default = 0)\n"
               "-outx output extension (default = sx, image filename ext)\n"
+              "-hull write convex billboard hulls per cell and for the sequence, prefixName'SEQHull.xml'\n"
+              "-hv max hull vertices, range[4, 16] (default = 8)\n"
+              "-ht hull coverage threshold, alpha or average color, range[0, 1] (default = 0.05)\n"
               "-v verbose output\n"
               "-h shows this help message\n\n"
               "Example: SequenceImagePacker myfilepath -sp fire -sx png -ss 4 -se 32 -sf 02 -ox 22 -fh 40 -outx jpg\n\n"
@@ -122,7 +105,6 @@ void Run(Vector<String>& arguments)
     SharedPtr<Context> context(new Context());
     context->RegisterSubsystem(new FileSystem(context));
     context->RegisterSubsystem(new Log(context));
-    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
 
     String inputPath;
     String seqPrefix;
@@ -133,14 +115,15 @@ void Run(Vector<String>& arguments)
     int seqFormat = 1;
     String strFormat;
     bool hasLeadingZero = false;
-    unsigned components = 0;
-    int depth = 0;
 
     int offsetX = 0;
     int offsetY = 0;
     int frameWidth = 0;
     int frameHeight = 0;
     bool verbose = false;
+    bool buildHulls = false;
+    int hullVerts = 8;
+    float hullThreshold = 0.05f;
 
     // input path
     inputPath = arguments[0];
@@ -167,6 +150,9 @@ void Run(Vector<String>& arguments)
             else if (arg == "-ox"  ) { offsetX = ToInt(arguments[0]); arguments.Erase(0); }
             else if (arg == "-oy"  ) { offsetY = ToInt(arguments[0]); arguments.Erase(0); }
             else if (arg == "-outx") { outExt = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-hull") { buildHulls = true; }
+            else if (arg == "-hv"  ) { hullVerts = ToInt(arguments[0]); arguments.Erase(0); }
+            else if (arg == "-ht"  ) { hullThreshold = ToFloat(arguments[0]); arguments.Erase(0); }
             else if (arg == "-v"   ) { verbose = true; }
             else if (arg == "-h"   ) { Help(); }
 
@@ -177,260 +163,56 @@ void Run(Vector<String>& arguments)
         }
     }
 
-    // evaluate seqs
-    if (seqStart < 0 || seqEnd < 0 || seqEnd - seqStart < 2)
-    {
-        ErrorExit("improper ss and/or se");
-    }
-
     // check dec format
     hasLeadingZero = strFormat.StartsWith("0");
     const char *p = hasLeadingZero?strFormat.CString()+1:strFormat.CString();
     seqFormat = Variant(VAR_INT, p).GetInt();
 
-    if (seqFormat < 1 || seqFormat > 3)
-    {
-        ErrorExit("sf not in range");
-    }
-
-    // validate input path
-    String filePath;
-
-    if (!inputPath.Empty())
-    {
-        inputPath = RemoveTrailingSlash(inputPath);
-
-        if (fileSystem->DirExists(inputPath))
-        {
-            filePath = inputPath;
-        }
-
-        filePath = AddTrailingSlash(filePath);
-    }
-
-    if (verbose)
-    {
-        PrintLine("Input path: " + GetPath(filePath));
-        PrintLine("Seq start " + String(seqStart) + ", end "+ String(seqEnd));
-    }
-
-    // query how many files we can open to determine the layout
-    int itotalFiles = 0;
-    int imgH=0, imgW=0;
-
-    for ( int i = seqStart; i <= seqEnd; ++i )
-    {
-        char buff[16];
-        sprintf(buff, getSequenceDecFormat(seqFormat, hasLeadingZero), i);
-        String filename = filePath + seqPrefix + String(buff) + "." + seqExt;
-
-        if (!fileSystem->FileExists(filename))
-        {
-            continue;
-        }
-
-        File file(context, filename);
-        Image image(context);
-        if (!image.Load(file))
-        {
-            continue;
-        }
-
-        if (components == 0)
-        {
-            components = image.GetComponents();
-            depth = image.GetDepth();
-        }
-
-        int imageWidth = image.GetWidth();
-        int imageHeight = image.GetHeight();
-
-        if (imgW == 0)
-        {
-            imgW = imageWidth;
-            if (frameWidth > 0 || offsetX > 0)
-            {
-                if (imageWidth < frameWidth + offsetX)
-                {
-                    if (frameWidth > 0)
-                    {
-                        if (verbose)
-                        {
-                            PrintLine("fw + ox > image width, changing fw to fit");
-                        }
-                        frameWidth = imageWidth - offsetX;
-                    }
-                    else
-                    {
-                        ErrorExit("ox > image width");
-                    }
-                }
-            }
-        }
-        else if (imgW != imageWidth)
-        {
-            ErrorExit("inconsistent image width");
-        }
-
-        if (imgH == 0)
-        {
-            imgH = imageHeight;
-            if (frameHeight > 0 || offsetY > 0)
-            {
-                if (imageHeight < frameHeight + offsetY)
-                {
-                    if (frameHeight > 0)
-                    {
-                        if (verbose)
-                        {
-                            PrintLine("fh + oy > image height, changing fh to fit");
-                        }
-                        frameHeight = imageHeight - offsetY;
-                    }
-                    else
-                    {
-                        ErrorExit("oy > image height");
-                    }
-                }
-            }
-        }
-        else if (imgH != imageHeight)
-        {
-            ErrorExit("inconsistent image height");
-        }
-
-        ++itotalFiles;
-    }
-
-    if (itotalFiles == 0)
-    {
-        ErrorExit("didn't find any files to open");
-    }
-
-    if (verbose)
-    {
-        PrintLine("Num image files to pack: " + String(itotalFiles));
-    }
-
-    // check components
-    if (components == 0)
-    {
-        ErrorExit("image component not detected");
-    }
-
-    // determine an efficient layout, min rows = sqrtNum/1.5 to avoid creating a single row
-    int sqrtNum = (int)ceil(sqrt((float)itotalFiles));
-    int rows = sqrtNum;
-    int cols = (int)ceil((float)itotalFiles/(float)rows);
-    int maxTiles = rows * cols;
-    int minRows = (int)((float)sqrtNum/(1.5f));
-
-    for ( int i = 1; i < minRows; ++i )
-    {
-        int r = sqrtNum - i;
-        int c = (int)ceil((float)itotalFiles/(float)r);
-        if (r * c < maxTiles)
+    SequencePackParams params;
+    params.inputPath_   = inputPath;
+    params.seqPrefix_   = seqPrefix;
+    params.seqExt_      = seqExt;
+    params.outExt_      = outExt;
+    params.seqStart_    = seqStart;
+    params.seqEnd_      = seqEnd;
+    params.seqFormat_   = seqFormat;
+    params.leadingZero_ = hasLeadingZero;
+    params.offsetX_     = offsetX;
+    params.offsetY_     = offsetY;
+    params.frameWidth_  = frameWidth;
+    params.frameHeight_ = frameHeight;
+    params.verbose_     = verbose;
+    params.buildHulls_  = buildHulls;
+    params.hullVerts_   = hullVerts;
+    params.hullThreshold_ = hullThreshold;
+
+    SequencePackResult result;
+
+    if (!PackSequence(context, params, result))
+    {
+        if (!result.saved_ && !result.outputFile_.Empty())
         {
-            rows = r;
-            cols = c;
-            maxTiles = r * c;
+            PrintLine(result.error_);
+            return;
         }
-    }
-
-    if (verbose)
-    {
-        PrintLine("Packing images: row " + String(rows) + ", col " + String(cols));
-    }
-
-    // pack sequence images
-    int readEndW = frameWidth>0?offsetX+frameWidth:imgW;
-    int readEndH = frameHeight>0?offsetY+frameHeight:imgH;
-    int writeW = frameWidth>0?frameWidth:imgW-offsetX;
-    int writeH = frameHeight>0?frameHeight:imgH-offsetY;
 
-    if (verbose)
-    {
-        PrintLine("Pixels to read(" + String(readEndW) + ", " + String(readEndH) + "), to write("+ 
-                  String(writeW) + ", " + String(writeH) + ") per image.");
-    }
-
-    Image packedImage(context);
-    packedImage.SetSize(cols * writeW, rows * writeH, depth, components);
-    packedImage.Clear(Color::BLACK);
-
-    for ( int r = 0; r < rows; ++r )
-    {
-        int seq = seqStart + r * cols;
-
-        for ( int c = 0; c < cols && seq <= seqEnd; ++c, ++seq )
-        {
-            char buff[16];
-            sprintf(buff, getSequenceDecFormat(seqFormat, hasLeadingZero), seq);
-            String filename = filePath + seqPrefix + String(buff) + "." + seqExt;
-
-            if (!fileSystem->FileExists(filename))
-            {
-                if (verbose)
-                {
-                    PrintLine("File not found: " + GetFileNameAndExtension(filename));
-                }
-
-                continue;
-            }
-
-            File file(context, filename);
-            Image image(context);
-
-            if (!image.Load(file))
-            {
-                if (verbose)
-                {
-                    PrintLine("Failed to read image: " + GetFileNameAndExtension(filename));
-                }
-
-                continue;
-            }
-
-            for ( int yr = offsetY, yw = 0; yr < readEndH; ++yr, ++yw )
-            {
-                for ( int xr = offsetX, xw = 0; xr < readEndW; ++xr, ++xw )
-                {
-                    unsigned color = image.GetPixelInt(xr, yr);
-                    packedImage.SetPixelInt(xw + c * writeW, yw + r * writeH, color);
-                }
-            }
-        }
+        ErrorExit(result.error_);
     }
 
-    // save file
-    String ext = !outExt.Empty()?outExt:seqExt;
-    String filename = filePath + seqPrefix + "SEQ." + ext;
-    bool saved = false;
+    PrintLine("File saved as: " + GetPath(result.outputFile_) + GetFileNameAndExtension(result.outputFile_));
+    PrintLine("row " + String(result.rows_) + ", col " + String(result.cols_) + ", num images " + String(result.numImages_));
 
-    if (ext.Compare("JPG", false))
-    {
-        saved = packedImage.SaveJPG(filename, 100);
-    }
-    else if (ext.Compare("PNG", false))
-    {
-        saved = packedImage.SavePNG(filename);
-    }
-    else if (ext.Compare("TGA", false))
+    if (buildHulls)
     {
-        saved = packedImage.SaveTGA(filename);
-    }
-    else if (ext.Compare("BMP", false))
-    {
-        saved = packedImage.SaveBMP(filename);
-    }
+        const SequenceHullResult &hulls = result.hulls_;
+        double quadPixels = (double)Max(hulls.quadPixels_, 1LL);
 
-    String outstr = saved ? "File saved as: " : "Failed to save: ";
-    outstr += GetPath(filename) + GetFileNameAndExtension(filename);
-    PrintLine(outstr);
-
-    if (saved)
-    {
-        PrintLine("row " + String(rows) + ", col " + String(cols) + ", num images " + String(itotalFiles));
+        PrintLine("Hulls saved as: " + GetPath(hulls.outputFile_) + GetFileNameAndExtension(hulls.outputFile_));
+        PrintLine("pixels per sequence: quads " + String((unsigned)hulls.quadPixels_) +
+                  ", covered " + String((unsigned)hulls.coveredPixels_) +
+                  ", cell hulls " + String((unsigned)hulls.cellHullPixels_) +
+                  ", union hull " + String((unsigned)hulls.unionHullPixels_));
+        PrintLine("savings: cell hulls " + String((float)(100.0 * (1.0 - hulls.cellHullPixels_ / quadPixels))) +
+                  "%, union hull " + String((float)(100.0 * (1.0 - hulls.unionHullPixels_ / quadPixels))) + "%");
     }
 }
-
@@ -0,0 +1,640 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Math/Rect.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/XMLElement.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#include <stdio.h>
+
+#include "SequencePacker.h"
+
+#include <Urho3D/DebugNew.h>
+
+//=============================================================================
+//=============================================================================
+const char *GetSequenceDecFormat(int idx, bool leadingZero)
+{
+    const char *dec1Format = "%1d";
+    const char *dec2Format = "%2d";
+    const char *dec3Format = "%3d";
+    const char *dec02Format = "%02d";
+    const char *dec03Format = "%03d";
+
+    if (idx == 1)
+    {
+        return dec1Format;
+    }
+    else if (idx == 2)
+    {
+        return leadingZero?dec02Format:dec2Format;
+    }
+
+    return leadingZero?dec03Format:dec3Format;
+}
+
+//=============================================================================
+//=============================================================================
+bool PackSequence(Context *context, SequencePackParams &params, SequencePackResult &result)
+{
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+    HiresTimer totalTimer;
+    HiresTimer stepTimer;
+
+    unsigned components = 0;
+    int depth = 0;
+    int frameWidth = params.frameWidth_;
+    int frameHeight = params.frameHeight_;
+    const int offsetX = params.offsetX_;
+    const int offsetY = params.offsetY_;
+    const bool verbose = params.verbose_;
+
+    // evaluate seqs
+    if (params.seqStart_ < 0 || params.seqEnd_ < 0 || params.seqEnd_ - params.seqStart_ < 2)
+    {
+        result.error_ = "improper ss and/or se";
+        return false;
+    }
+
+    if (params.seqFormat_ < 1 || params.seqFormat_ > 3)
+    {
+        result.error_ = "sf not in range";
+        return false;
+    }
+
+    // validate input path
+    String filePath;
+
+    if (!params.inputPath_.Empty())
+    {
+        String inputPath = RemoveTrailingSlash(params.inputPath_);
+
+        if (fileSystem->DirExists(inputPath))
+        {
+            filePath = inputPath;
+        }
+
+        filePath = AddTrailingSlash(filePath);
+    }
+
+    if (verbose)
+    {
+        PrintLine("Input path: " + GetPath(filePath));
+        PrintLine("Seq start " + String(params.seqStart_) + ", end "+ String(params.seqEnd_));
+    }
+
+    const char *decFormat = GetSequenceDecFormat(params.seqFormat_, params.leadingZero_);
+
+    // query how many files we can open to determine the layout
+    int itotalFiles = 0;
+    int imgH=0, imgW=0;
+
+    for ( int i = params.seqStart_; i <= params.seqEnd_; ++i )
+    {
+        char buff[16];
+        sprintf(buff, decFormat, i);
+        String filename = filePath + params.seqPrefix_ + String(buff) + "." + params.seqExt_;
+
+        if (!fileSystem->FileExists(filename))
+        {
+            continue;
+        }
+
+        stepTimer.Reset();
+        File file(context, filename);
+        Image image(context);
+        bool loaded = image.Load(file);
+        result.decodeUSec_ += stepTimer.GetUSec(false);
+
+        if (!loaded)
+        {
+            continue;
+        }
+
+        if (components == 0)
+        {
+            components = image.GetComponents();
+            depth = image.GetDepth();
+        }
+
+        int imageWidth = image.GetWidth();
+        int imageHeight = image.GetHeight();
+
+        if (imgW == 0)
+        {
+            imgW = imageWidth;
+            if (frameWidth > 0 || offsetX > 0)
+            {
+                if (imageWidth < frameWidth + offsetX)
+                {
+                    if (frameWidth > 0)
+                    {
+                        if (verbose)
+                        {
+                            PrintLine("fw + ox > image width, changing fw to fit");
+                        }
+                        frameWidth = imageWidth - offsetX;
+                    }
+                    else
+                    {
+                        result.error_ = "ox > image width";
+                        return false;
+                    }
+                }
+            }
+        }
+        else if (imgW != imageWidth)
+        {
+            result.error_ = "inconsistent image width";
+            return false;
+        }
+
+        if (imgH == 0)
+        {
+            imgH = imageHeight;
+            if (frameHeight > 0 || offsetY > 0)
+            {
+                if (imageHeight < frameHeight + offsetY)
+                {
+                    if (frameHeight > 0)
+                    {
+                        if (verbose)
+                        {
+                            PrintLine("fh + oy > image height, changing fh to fit");
+                        }
+                        frameHeight = imageHeight - offsetY;
+                    }
+                    else
+                    {
+                        result.error_ = "oy > image height";
+                        return false;
+                    }
+                }
+            }
+        }
+        else if (imgH != imageHeight)
+        {
+            result.error_ = "inconsistent image height";
+            return false;
+        }
+
+        ++itotalFiles;
+    }
+
+    if (itotalFiles == 0)
+    {
+        result.error_ = "didn't find any files to open";
+        return false;
+    }
+
+    if (verbose)
+    {
+        PrintLine("Num image files to pack: " + String(itotalFiles));
+    }
+
+    // check components
+    if (components == 0)
+    {
+        result.error_ = "image component not detected";
+        return false;
+    }
+
+    // determine an efficient layout, min rows = sqrtNum/1.5 to avoid creating a single row
+    int sqrtNum = (int)ceil(sqrt((float)itotalFiles));
+    int rows = sqrtNum;
+    int cols = (int)ceil((float)itotalFiles/(float)rows);
+    int maxTiles = rows * cols;
+    int minRows = (int)((float)sqrtNum/(1.5f));
+
+    for ( int i = 1; i < minRows; ++i )
+    {
+        int r = sqrtNum - i;
+        int c = (int)ceil((float)itotalFiles/(float)r);
+        if (r * c < maxTiles)
+        {
+            rows = r;
+            cols = c;
+            maxTiles = r * c;
+        }
+    }
+
+    if (verbose)
+    {
+        PrintLine("Packing images: row " + String(rows) + ", col " + String(cols));
+    }
+
+    // pack sequence images
+    int readEndW = frameWidth>0?offsetX+frameWidth:imgW;
+    int readEndH = frameHeight>0?offsetY+frameHeight:imgH;
+    int writeW = frameWidth>0?frameWidth:imgW-offsetX;
+    int writeH = frameHeight>0?frameHeight:imgH-offsetY;
+
+    if (verbose)
+    {
+        PrintLine("Pixels to read(" + String(readEndW) + ", " + String(readEndH) + "), to write("+
+                  String(writeW) + ", " + String(writeH) + ") per image.");
+    }
+
+    SharedPtr<Image> packedImage(new Image(context));
+    packedImage->SetSize(cols * writeW, rows * writeH, depth, components);
+    packedImage->Clear(Color::BLACK);
+
+    for ( int r = 0; r < rows; ++r )
+    {
+        int seq = params.seqStart_ + r * cols;
+
+        for ( int c = 0; c < cols && seq <= params.seqEnd_; ++c, ++seq )
+        {
+            char buff[16];
+            sprintf(buff, decFormat, seq);
+            String filename = filePath + params.seqPrefix_ + String(buff) + "." + params.seqExt_;
+
+            if (!fileSystem->FileExists(filename))
+            {
+                if (verbose)
+                {
+                    PrintLine("File not found: " + GetFileNameAndExtension(filename));
+                }
+
+                continue;
+            }
+
+            stepTimer.Reset();
+            File file(context, filename);
+            Image image(context);
+            bool loaded = image.Load(file);
+            result.decodeUSec_ += stepTimer.GetUSec(false);
+
+            if (!loaded)
+            {
+                if (verbose)
+                {
+                    PrintLine("Failed to read image: " + GetFileNameAndExtension(filename));
+                }
+
+                continue;
+            }
+
+            stepTimer.Reset();
+            for ( int yr = offsetY, yw = 0; yr < readEndH; ++yr, ++yw )
+            {
+                for ( int xr = offsetX, xw = 0; xr < readEndW; ++xr, ++xw )
+                {
+                    unsigned color = image.GetPixelInt(xr, yr);
+                    packedImage->SetPixelInt(xw + c * writeW, yw + r * writeH, color);
+                }
+            }
+            result.blitUSec_ += stepTimer.GetUSec(false);
+        }
+    }
+
+    result.rows_ = rows;
+    result.cols_ = cols;
+    result.numImages_ = itotalFiles;
+    result.packedImage_ = packedImage;
+
+    // save file
+    if (params.saveOutput_)
+    {
+        String ext = !params.outExt_.Empty()?params.outExt_:params.seqExt_;
+        String filename = filePath + params.seqPrefix_ + "SEQ." + ext;
+        bool saved = false;
+
+        stepTimer.Reset();
+        if (ext.Compare("JPG", false) == 0)
+        {
+            saved = packedImage->SaveJPG(filename, 100);
+        }
+        else if (ext.Compare("PNG", false) == 0)
+        {
+            saved = packedImage->SavePNG(filename);
+        }
+        else if (ext.Compare("TGA", false) == 0)
+        {
+            saved = packedImage->SaveTGA(filename);
+        }
+        else if (ext.Compare("BMP", false) == 0)
+        {
+            saved = packedImage->SaveBMP(filename);
+        }
+        result.encodeUSec_ = stepTimer.GetUSec(false);
+
+        result.saved_ = saved;
+        result.outputFile_ = filename;
+
+        if (!saved)
+        {
+            result.error_ = "Failed to save: " + GetPath(filename) + GetFileNameAndExtension(filename);
+        }
+    }
+
+    // tight hulls
+    if (params.buildHulls_)
+    {
+        stepTimer.Reset();
+        BuildSequenceHulls(params, result);
+        result.hullUSec_ = stepTimer.GetUSec(false);
+
+        if (params.saveOutput_)
+        {
+            String filename = filePath + params.seqPrefix_ + "SEQHull.xml";
+
+            if (!SaveSequenceHulls(context, filename, result) && result.error_.Empty())
+            {
+                result.error_ = "Failed to save: " + GetPath(filename) + GetFileNameAndExtension(filename);
+            }
+        }
+    }
+
+    result.totalUSec_ = totalTimer.GetUSec(false);
+
+    return result.error_.Empty();
+}
+
+//=============================================================================
+// hull helpers, cell pixel space with y down
+//=============================================================================
+static bool CompareHullPoints(const Vector2 &lhs, const Vector2 &rhs)
+{
+    return lhs.x_ < rhs.x_ || (lhs.x_ == rhs.x_ && lhs.y_ < rhs.y_);
+}
+
+static float HullCross(const Vector2 &o, const Vector2 &a, const Vector2 &b)
+{
+    return (a.x_ - o.x_) * (b.y_ - o.y_) - (a.y_ - o.y_) * (b.x_ - o.x_);
+}
+
+static void ComputeConvexHull(PODVector<Vector2> &points, PODVector<Vector2> &hull)
+{
+    hull.Clear();
+
+    if (points.Size() < 3)
+    {
+        hull = points;
+        return;
+    }
+
+    // monotone chain
+    Sort(points.Begin(), points.End(), CompareHullPoints);
+
+    hull.Resize(points.Size() * 2);
+    unsigned k = 0;
+
+    for ( unsigned i = 0; i < points.Size(); ++i )
+    {
+        while (k >= 2 && HullCross(hull[k - 2], hull[k - 1], points[i]) <= 0.0f)
+            --k;
+        hull[k++] = points[i];
+    }
+
+    for ( int i = (int)points.Size() - 2, lower = k + 1; i >= 0; --i )
+    {
+        while ((int)k >= lower && HullCross(hull[k - 2], hull[k - 1], points[i]) <= 0.0f)
+            --k;
+        hull[k++] = points[i];
+    }
+
+    // last point is the first one
+    hull.Resize(k - 1);
+}
+
+static void ReduceHull(PODVector<Vector2> &hull, unsigned maxVerts, float width, float height)
+{
+    const float eps = 0.001f;
+
+    // collapse the edge that adds the least area when its neighbour edges are extended to meet,
+    // the result still contains the original hull
+    while (hull.Size() > maxVerts)
+    {
+        unsigned num = hull.Size();
+        unsigned bestEdge = M_MAX_UNSIGNED;
+        float bestArea = M_INFINITY;
+        Vector2 bestPoint;
+
+        for ( unsigned i = 0; i < num; ++i )
+        {
+            const Vector2 &p0 = hull[(i + num - 1) % num];
+            const Vector2 &a  = hull[i];
+            const Vector2 &b  = hull[(i + 1) % num];
+            const Vector2 &p3 = hull[(i + 2) % num];
+
+            Vector2 d0 = a - p0;
+            Vector2 d1 = p3 - b;
+            float denom = d0.x_ * d1.y_ - d0.y_ * d1.x_;
+
+            if (Abs(denom) < M_EPSILON)
+                continue;
+
+            Vector2 ab = b - p0;
+            float t = (ab.x_ * d1.y_ - ab.y_ * d1.x_) / denom;
+            float u = (ab.x_ * d0.y_ - ab.y_ * d0.x_) / denom;
+
+            // the lines have to meet past a and before b
+            if (t <= 1.0f || u >= 0.0f)
+                continue;
+
+            Vector2 q = p0 + d0 * t;
+
+            if (q.x_ < -eps || q.y_ < -eps || q.x_ > width + eps || q.y_ > height + eps)
+                continue;
+
+            float area = Abs(HullCross(q, a, b)) * 0.5f;
+
+            if (area < bestArea)
+            {
+                bestArea = area;
+                bestEdge = i;
+                bestPoint = q;
+            }
+        }
+
+        // nothing left to collapse inside the cell, the bounding rect always fits
+        if (bestEdge == M_MAX_UNSIGNED)
+        {
+            Rect bounds(hull[0], hull[0]);
+            for ( unsigned i = 1; i < num; ++i )
+                bounds.Merge(hull[i]);
+
+            hull.Clear();
+            hull.Push(bounds.min_);
+            hull.Push(Vector2(bounds.max_.x_, bounds.min_.y_));
+            hull.Push(bounds.max_);
+            hull.Push(Vector2(bounds.min_.x_, bounds.max_.y_));
+            return;
+        }
+
+        hull[bestEdge] = bestPoint;
+        hull.Erase((bestEdge + 1) % num);
+    }
+}
+
+static long long RasterizeHull(const PODVector<Vector2> &hull, int width, int height)
+{
+    if (hull.Size() < 3)
+        return 0;
+
+    // the hull winding depends on the cross sign, count pixel centers on the inner side of every edge
+    float sign = HullCross(hull[0], hull[1], hull[2]) > 0.0f ? 1.0f : -1.0f;
+    long long pixels = 0;
+
+    for ( int y = 0; y < height; ++y )
+    {
+        for ( int x = 0; x < width; ++x )
+        {
+            Vector2 center((float)x + 0.5f, (float)y + 0.5f);
+            bool inside = true;
+
+            for ( unsigned i = 0; i < hull.Size() && inside; ++i )
+            {
+                inside = HullCross(hull[i], hull[(i + 1) % hull.Size()], center) * sign >= 0.0f;
+            }
+
+            if (inside)
+                ++pixels;
+        }
+    }
+
+    return pixels;
+}
+
+//=============================================================================
+//=============================================================================
+void BuildSequenceHulls(const SequencePackParams &params, SequencePackResult &result)
+{
+    SequenceHullResult &hulls = result.hulls_;
+    Image *image = result.packedImage_;
+
+    if (!image || result.rows_ == 0 || result.cols_ == 0)
+    {
+        return;
+    }
+
+    const int cellW = image->GetWidth() / result.cols_;
+    const int cellH = image->GetHeight() / result.rows_;
+    const int numCells = Min(result.rows_ * result.cols_, params.seqEnd_ - params.seqStart_ + 1);
+    const unsigned maxVerts = (unsigned)Clamp(params.hullVerts_, 4, 16);
+    const bool hasAlpha = image->GetComponents() == 4;
+    const int threshold = (int)(Clamp(params.hullThreshold_, 0.0f, 1.0f) * 255.0f);
+
+    hulls.cellWidth_ = cellW;
+    hulls.cellHeight_ = cellH;
+    hulls.cellHulls_.Resize(numCells);
+
+    PODVector<Vector2> unionPoints;
+    PODVector<Vector2> points;
+    PODVector<Vector2> hull;
+
+    for ( int cell = 0; cell < numCells; ++cell )
+    {
+        int x0 = (cell % result.cols_) * cellW;
+        int y0 = (cell / result.cols_) * cellH;
+        points.Clear();
+
+        // row spans of covered pixels, pixel corners so the hull contains whole pixels
+        for ( int y = 0; y < cellH; ++y )
+        {
+            int minX = -1;
+            int maxX = -1;
+
+            for ( int x = 0; x < cellW; ++x )
+            {
+                unsigned color = image->GetPixelInt(x0 + x, y0 + y);
+                int coverage = hasAlpha ? (int)(color >> 24) :
+                               (int)((color & 0xff) + ((color >> 8) & 0xff) + ((color >> 16) & 0xff)) / 3;
+
+                if (coverage > threshold)
+                {
+                    if (minX < 0)
+                        minX = x;
+                    maxX = x;
+                    ++hulls.coveredPixels_;
+                }
+            }
+
+            if (minX >= 0)
+            {
+                points.Push(Vector2((float)minX, (float)y));
+                points.Push(Vector2((float)minX, (float)(y + 1)));
+                points.Push(Vector2((float)(maxX + 1), (float)y));
+                points.Push(Vector2((float)(maxX + 1), (float)(y + 1)));
+            }
+        }
+
+        unionPoints.Push(points);
+        hulls.quadPixels_ += cellW * cellH;
+
+        ComputeConvexHull(points, hull);
+        ReduceHull(hull, maxVerts, (float)cellW, (float)cellH);
+        hulls.cellHullPixels_ += RasterizeHull(hull, cellW, cellH);
+
+        PODVector<Vector2> &cellHull = hulls.cellHulls_[cell];
+        for ( unsigned i = 0; i < hull.Size(); ++i )
+            cellHull.Push(Vector2(hull[i].x_ / (float)cellW, hull[i].y_ / (float)cellH));
+    }
+
+    // one hull for the whole sequence, fits the fixed geometry a uv frame sequencer draws
+    ComputeConvexHull(unionPoints, hull);
+    ReduceHull(hull, maxVerts, (float)cellW, (float)cellH);
+    hulls.unionHullPixels_ = RasterizeHull(hull, cellW, cellH) * numCells;
+
+    for ( unsigned i = 0; i < hull.Size(); ++i )
+        hulls.unionHull_.Push(Vector2(hull[i].x_ / (float)cellW, hull[i].y_ / (float)cellH));
+}
+
+bool SaveSequenceHulls(Context *context, const String &fileName, SequencePackResult &result)
+{
+    const SequenceHullResult &hulls = result.hulls_;
+
+    XMLFile xmlFile(context);
+    XMLElement root = xmlFile.CreateRoot("hulls");
+    root.SetInt("rows", result.rows_);
+    root.SetInt("cols", result.cols_);
+    root.SetInt("cellWidth", hulls.cellWidth_);
+    root.SetInt("cellHeight", hulls.cellHeight_);
+
+    XMLElement unionElem = root.CreateChild("union");
+    for ( unsigned i = 0; i < hulls.unionHull_.Size(); ++i )
+        unionElem.CreateChild("vertex").SetVector2("uv", hulls.unionHull_[i]);
+
+    for ( unsigned c = 0; c < hulls.cellHulls_.Size(); ++c )
+    {
+        XMLElement cellElem = root.CreateChild("cell");
+        cellElem.SetInt("index", c);
+
+        for ( unsigned i = 0; i < hulls.cellHulls_[c].Size(); ++i )
+            cellElem.CreateChild("vertex").SetVector2("uv", hulls.cellHulls_[c][i]);
+    }
+
+    File file(context, fileName, FILE_WRITE);
+    result.hulls_.saved_ = file.IsOpen() && xmlFile.Save(file);
+    result.hulls_.outputFile_ = fileName;
+
+    return result.hulls_.saved_;
+}
@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Container/Vector.h>
+#include <Urho3D/Math/Vector2.h>
+
+namespace Urho3D
+{
+class Context;
+class Image;
+}
+
+using namespace Urho3D;
+
+//=============================================================================
+//=============================================================================
+struct SequencePackParams
+{
+    SequencePackParams()
+        : seqStart_(0)
+        , seqEnd_(0)
+        , seqFormat_(1)
+        , leadingZero_(false)
+        , offsetX_(0)
+        , offsetY_(0)
+        , frameWidth_(0)
+        , frameHeight_(0)
+        , saveOutput_(true)
+        , verbose_(false)
+        , buildHulls_(false)
+        , hullVerts_(8)
+        , hullThreshold_(0.05f)
+    {
+    }
+
+    String inputPath_;
+    String seqPrefix_;
+    String seqExt_;
+    String outExt_;
+    int    seqStart_;
+    int    seqEnd_;
+    int    seqFormat_;
+    bool   leadingZero_;
+
+    int    offsetX_;
+    int    offsetY_;
+    int    frameWidth_;
+    int    frameHeight_;
+
+    bool   saveOutput_;
+    bool   verbose_;
+
+    // tight billboard hulls, written next to the atlas as prefixName'SEQHull.xml'
+    bool   buildHulls_;
+    int    hullVerts_;
+    float  hullThreshold_;      // coverage threshold, alpha or average color for images without alpha
+};
+
+//=============================================================================
+//=============================================================================
+struct SequenceHullResult
+{
+    SequenceHullResult()
+        : cellWidth_(0)
+        , cellHeight_(0)
+        , quadPixels_(0)
+        , coveredPixels_(0)
+        , cellHullPixels_(0)
+        , unionHullPixels_(0)
+        , saved_(false)
+    {
+    }
+
+    int                         cellWidth_;
+    int                         cellHeight_;
+
+    // convex hulls in cell uv space, (0, 0) = top left of the cell, empty for fully transparent cells
+    Vector<PODVector<Vector2> > cellHulls_;
+    PODVector<Vector2>          unionHull_;
+
+    // pixels shaded for all cells, counted by rasterizing the hulls on the cpu
+    long long                   quadPixels_;
+    long long                   coveredPixels_;
+    long long                   cellHullPixels_;
+    long long                   unionHullPixels_;
+
+    bool                        saved_;
+    String                      outputFile_;
+};
+
+//=============================================================================
+//=============================================================================
+struct SequencePackResult
+{
+    SequencePackResult()
+        : rows_(0)
+        , cols_(0)
+        , numImages_(0)
+        , saved_(false)
+        , decodeUSec_(0)
+        , blitUSec_(0)
+        , encodeUSec_(0)
+        , totalUSec_(0)
+        , hullUSec_(0)
+    {
+    }
+
+    int               rows_;
+    int               cols_;
+    int               numImages_;
+    bool              saved_;
+    String            outputFile_;
+    String            error_;
+    SharedPtr<Image>  packedImage_;
+    SequenceHullResult hulls_;
+
+    // timings, in microseconds
+    long long         decodeUSec_;
+    long long         blitUSec_;
+    long long         encodeUSec_;
+    long long         totalUSec_;
+    long long         hullUSec_;
+};
+
+//=============================================================================
+//=============================================================================
+const char *GetSequenceDecFormat(int idx, bool leadingZero);
+
+/// Pack an image sequence into a single atlas image. Returns false and fills result.error_ on failure.
+bool PackSequence(Context *context, SequencePackParams &params, SequencePackResult &result);
+
+/// Compute a convex hull of at most params.hullVerts_ vertices per packed cell and one for the whole sequence.
+void BuildSequenceHulls(const SequencePackParams &params, SequencePackResult &result);
+
+/// Save the hulls as xml, read by HullBillboard in the sample.
+bool SaveSequenceHulls(Context *context, const String &fileName, SequencePackResult &result);
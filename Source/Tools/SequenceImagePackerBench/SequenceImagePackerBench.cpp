@@ -0,0 +1,385 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/JSONFile.h>
+
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+
+#include "../SequenceImagePacker/SequencePacker.h"
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+//=============================================================================
+int main(int argc, char** argv);
+int Run(Vector<String>& arguments);
+
+struct BenchCase
+{
+    int width_;
+    int height_;
+    int numFrames_;
+    unsigned components_;
+};
+
+// synthesized sequences: frame size, frame count, components
+static const BenchCase benchCases[] =
+{
+    {  64,  64,  16, 3 },
+    {  64,  64,  16, 4 },
+    { 256, 256,  32, 3 },
+    { 256, 256,  32, 4 },
+    { 213, 120, 123, 3 },   // bgfire layout
+    { 260, 180, 100, 3 },   // explosion2 layout
+    { 640, 360,  64, 4 },
+};
+static const unsigned numBenchCases = sizeof(benchCases) / sizeof(benchCases[0]);
+
+//=============================================================================
+//=============================================================================
+void Help(const String &message = String::EMPTY)
+{
+    if (!message.Empty())
+    {
+        PrintLine(message);
+    }
+
+    ErrorExit("SequenceImagePackerBench, packing throughput and regression check for SequenceImagePacker\n"
+              "Usage: SequenceImagePackerBench -options\n\n"
+              "options:\n"
+              "-o json output file (default = stdout)\n"
+              "-g golden image folder, packed results are compared against caseName.png in this folder\n"
+              "-u update (write) the golden images instead of comparing\n"
+              "-n repeat count per case, the fastest run is reported (default = 1)\n"
+              "-k keep the synthesized sequences in the temp folder\n"
+              "-v verbose output\n"
+              "-h shows this help message\n\n"
+              "Exit code is non-zero if any case fails to pack or differs from its golden image.\n");
+}
+
+//=============================================================================
+//=============================================================================
+unsigned long long GetPeakRSS()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return (unsigned long long)counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return (unsigned long long)usage.ru_maxrss;
+#else
+    // kilobytes on linux
+    return (unsigned long long)usage.ru_maxrss * 1024ull;
+#endif
+#endif
+}
+
+String GetCaseName(const BenchCase &benchCase)
+{
+    return "seq" + String(benchCase.width_) + "x" + String(benchCase.height_) +
+           "f" + String(benchCase.numFrames_) + "c" + String(benchCase.components_);
+}
+
+// deterministic frame content so the packed output can be compared against a golden image
+bool SynthesizeSequence(Context *context, const BenchCase &benchCase, const String &dirPath)
+{
+    Image image(context);
+    image.SetSize(benchCase.width_, benchCase.height_, benchCase.components_);
+
+    for ( int f = 0; f < benchCase.numFrames_; ++f )
+    {
+        unsigned char *data = image.GetData();
+
+        for ( int y = 0; y < benchCase.height_; ++y )
+        {
+            for ( int x = 0; x < benchCase.width_; ++x )
+            {
+                unsigned char *pixel = data + (y * benchCase.width_ + x) * benchCase.components_;
+                pixel[0] = (unsigned char)((x * 255) / Max(benchCase.width_ - 1, 1));
+                pixel[1] = (unsigned char)((y * 255) / Max(benchCase.height_ - 1, 1));
+                pixel[2] = (unsigned char)(((x ^ y) + f * 7) & 0xff);
+
+                if (benchCase.components_ > 3)
+                {
+                    pixel[3] = (unsigned char)(((x + y + f) & 0x10) ? 0xff : 0x40);
+                }
+            }
+        }
+
+        char buff[16];
+        sprintf(buff, "%03d", f + 1);
+        if (!image.SavePNG(dirPath + "frame" + String(buff) + ".png"))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CompareImages(Image *lhs, Image *rhs)
+{
+    if (lhs->GetWidth() != rhs->GetWidth() || lhs->GetHeight() != rhs->GetHeight() ||
+        lhs->GetComponents() != rhs->GetComponents())
+    {
+        return false;
+    }
+
+    unsigned size = lhs->GetWidth() * lhs->GetHeight() * lhs->GetComponents();
+    return memcmp(lhs->GetData(), rhs->GetData(), size) == 0;
+}
+
+//=============================================================================
+//=============================================================================
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+#ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+#else
+    arguments = ParseArguments(argc, argv);
+#endif
+
+    return Run(arguments);
+}
+
+int Run(Vector<String>& arguments)
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new Log(context));
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+
+    String outputFile;
+    String goldenPath;
+    bool updateGolden = false;
+    bool keepFiles = false;
+    bool verbose = false;
+    int repeatCount = 1;
+
+    // parse args
+    while (arguments.Size() > 0)
+    {
+        String arg = arguments[0];
+        arguments.Erase(0);
+
+        if (arg.Empty())
+            continue;
+
+        if (arg.StartsWith("-"))
+        {
+                 if (arg == "-o" && arguments.Size()) { outputFile = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-g" && arguments.Size()) { goldenPath = AddTrailingSlash(arguments[0]); arguments.Erase(0); }
+            else if (arg == "-n" && arguments.Size()) { repeatCount = Max(ToInt(arguments[0]), 1); arguments.Erase(0); }
+            else if (arg == "-u") { updateGolden = true; }
+            else if (arg == "-k") { keepFiles = true; }
+            else if (arg == "-v") { verbose = true; }
+            else if (arg == "-h") { Help(); }
+            else { Help("Unknown option: " + arg); }
+        }
+        else
+        {
+            Help("Wrong arg order?");
+        }
+    }
+
+    if (updateGolden && goldenPath.Empty())
+    {
+        Help("-u requires a golden image folder, -g");
+    }
+
+    if (!goldenPath.Empty() && updateGolden)
+    {
+        fileSystem->CreateDir(goldenPath);
+    }
+
+    String tempPath = AddTrailingSlash(fileSystem->GetTemporaryDir());
+    if (tempPath.Length() < 2)
+    {
+        tempPath = fileSystem->GetProgramDir();
+    }
+    tempPath += "SequenceImagePackerBench/";
+    fileSystem->CreateDir(tempPath);
+
+    JSONFile json(context);
+    JSONValue& root = json.GetRoot();
+    JSONValue cases;
+    int numFailed = 0;
+
+    for ( unsigned i = 0; i < numBenchCases; ++i )
+    {
+        const BenchCase &benchCase = benchCases[i];
+        String caseName = GetCaseName(benchCase);
+        String casePath = tempPath + caseName + "/";
+        fileSystem->CreateDir(casePath);
+
+        if (verbose)
+        {
+            PrintLine("Synthesizing " + caseName);
+        }
+
+        if (!SynthesizeSequence(context, benchCase, casePath))
+        {
+            ErrorExit("failed to write sequence images to " + casePath);
+        }
+
+        SequencePackParams params;
+        params.inputPath_   = casePath;
+        params.seqPrefix_   = "frame";
+        params.seqExt_      = "png";
+        params.outExt_      = "png";
+        params.seqStart_    = 1;
+        params.seqEnd_      = benchCase.numFrames_;
+        params.seqFormat_   = 3;
+        params.leadingZero_ = true;
+        params.verbose_     = verbose;
+
+        SequencePackResult best;
+        bool packed = true;
+
+        for ( int r = 0; r < repeatCount && packed; ++r )
+        {
+            SequencePackResult result;
+            packed = PackSequence(context, params, result);
+
+            if (r == 0 || result.totalUSec_ < best.totalUSec_)
+            {
+                best = result;
+            }
+        }
+
+        String goldenStatus = "skipped";
+
+        if (packed && !goldenPath.Empty())
+        {
+            String goldenFile = goldenPath + caseName + ".png";
+
+            if (updateGolden)
+            {
+                goldenStatus = best.packedImage_->SavePNG(goldenFile) ? "updated" : "write failed";
+            }
+            else if (!fileSystem->FileExists(goldenFile))
+            {
+                goldenStatus = "missing";
+                ++numFailed;
+            }
+            else
+            {
+                File file(context, goldenFile);
+                Image golden(context);
+                bool match = golden.Load(file) && CompareImages(best.packedImage_, &golden);
+                goldenStatus = match ? "match" : "mismatch";
+
+                if (!match)
+                {
+                    ++numFailed;
+                }
+            }
+        }
+
+        if (!packed)
+        {
+            ++numFailed;
+        }
+
+        JSONValue entry;
+        entry.Set("name", caseName);
+        entry.Set("frameWidth", benchCase.width_);
+        entry.Set("frameHeight", benchCase.height_);
+        entry.Set("frames", benchCase.numFrames_);
+        entry.Set("components", (int)benchCase.components_);
+        entry.Set("packed", packed);
+        entry.Set("error", best.error_);
+        entry.Set("rows", best.rows_);
+        entry.Set("cols", best.cols_);
+        entry.Set("decodeMs", (double)best.decodeUSec_ / 1000.0);
+        entry.Set("blitMs", (double)best.blitUSec_ / 1000.0);
+        entry.Set("encodeMs", (double)best.encodeUSec_ / 1000.0);
+        entry.Set("totalMs", (double)best.totalUSec_ / 1000.0);
+        entry.Set("golden", goldenStatus);
+        cases.Push(entry);
+
+        if (verbose)
+        {
+            PrintLine(caseName + ": total " + String((double)best.totalUSec_ / 1000.0) + " ms, golden " + goldenStatus);
+        }
+
+        if (!keepFiles)
+        {
+            Vector<String> files;
+            fileSystem->ScanDir(files, casePath, "*.*", SCAN_FILES, false);
+            for ( unsigned f = 0; f < files.Size(); ++f )
+            {
+                fileSystem->Delete(casePath + files[f]);
+            }
+        }
+    }
+
+    root.Set("cases", cases);
+    root.Set("repeat", repeatCount);
+    root.Set("peakRSSBytes", (double)GetPeakRSS());
+    root.Set("failed", numFailed);
+
+    if (!outputFile.Empty())
+    {
+        File file(context, outputFile, FILE_WRITE);
+        if (!file.IsOpen() || !json.Save(file, "    "))
+        {
+            ErrorExit("failed to write " + outputFile);
+        }
+    }
+    else
+    {
+        VectorBuffer buffer;
+        json.Save(buffer, "    ");
+        PrintLine(String((const char*)buffer.GetData(), buffer.GetSize()));
+    }
+
+    return numFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
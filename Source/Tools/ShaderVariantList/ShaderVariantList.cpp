@@ -0,0 +1,524 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/HashSet.h>
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/XMLElement.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+//=============================================================================
+//=============================================================================
+int main(int argc, char** argv);
+int Run(Vector<String>& arguments);
+
+struct PassVariant
+{
+    String vs_;
+    String vsDefines_;
+    String ps_;
+    String psDefines_;
+};
+
+struct TechniqueInfo
+{
+    bool                loaded_;
+    Vector<String>      passNames_;
+    Vector<PassVariant> passes_;
+};
+
+// per-pixel lit passes, the renderer only ever compiles them with a light's defines appended (see
+// Renderer::LoadPassShaders/SetBatchShaders): the light type on both stages, SHADOW on both plus the
+// shadow quality define on the ps, and SPECULAR on the ps when the material has a specular color.
+// base and alpha are lit per vertex and keep their plain variant
+static const char* litPassNames[] = { "litbase", "light", "litalpha" };
+static const char* lightTypeDefines[] = { "PERPIXEL DIRLIGHT", "PERPIXEL SPOTLIGHT", "PERPIXEL POINTLIGHT" };
+static const unsigned numLitPassNames = sizeof(litPassNames) / sizeof(litPassNames[0]);
+static const unsigned numLightTypes = sizeof(lightTypeDefines) / sizeof(lightTypeDefines[0]);
+
+//=============================================================================
+//=============================================================================
+void Help(const String &message = String::EMPTY)
+{
+    if (!message.Empty())
+    {
+        PrintLine(message);
+    }
+
+    ErrorExit("ShaderVariantList, lists and validates the shader variants referenced by a material folder\n"
+              "Usage: ShaderVariantList materialFolderPath -options\n\n"
+              "options:\n"
+              "-r resource folders that techniques and shaders resolve against, ';' separated\n"
+              "   (default = material folder parent), e.g. bin/Data;bin/CoreData;bin/Data/MaterialEffects\n"
+              "-o warm-up list output file, engine shader precache xml (default = stdout)\n"
+              "-m merge a list recorded by the demo with -dumpshaders, adds geometry and light variants\n"
+              "   the static scan cannot know about\n"
+              "-a api sources to validate, GLSL, HLSL or all (default = all)\n"
+              "-l add per-pixel light variants for the litbase, light and litalpha passes, without it these\n"
+              "   passes are left out as the renderer never uses them without a light\n"
+              "-s shadow quality define added to shadowed light variants (default = PCF_SHADOW)\n"
+              "-v verbose output\n"
+              "-h shows this help message\n\n"
+              "Exit code is non-zero if a technique or shader source is missing.\n");
+}
+
+//=============================================================================
+//=============================================================================
+// sorted and space separated, matches the engine's define normalization so duplicates collapse
+String NormalizeDefines(const String &defines)
+{
+    Vector<String> tokens = defines.Split(' ');
+    Sort(tokens.Begin(), tokens.End());
+
+    String normalized;
+    for ( unsigned i = 0; i < tokens.Size(); ++i )
+    {
+        if (i > 0 && tokens[i] == tokens[i - 1])
+            continue;
+
+        if (!normalized.Empty())
+            normalized += " ";
+        normalized += tokens[i];
+    }
+
+    return normalized;
+}
+
+String AppendDefines(const String &defines, const String &extra)
+{
+    if (defines.Empty())
+        return extra;
+    if (extra.Empty())
+        return defines;
+
+    return defines + " " + extra;
+}
+
+String ResolvePath(FileSystem *fileSystem, const Vector<String> &roots, const String &name)
+{
+    for ( unsigned i = 0; i < roots.Size(); ++i )
+    {
+        if (fileSystem->FileExists(roots[i] + name))
+        {
+            return roots[i] + name;
+        }
+    }
+
+    return String::EMPTY;
+}
+
+bool LoadXML(Context *context, const String &path, XMLFile &xmlFile)
+{
+    File file(context, path, FILE_READ);
+    return file.IsOpen() && xmlFile.Load(file);
+}
+
+// a technique's passes with the technique level shaders and defines folded in the way Technique::Load does
+bool ParseTechnique(Context *context, const String &path, TechniqueInfo &info)
+{
+    XMLFile xmlFile(context);
+
+    if (!LoadXML(context, path, xmlFile))
+    {
+        return false;
+    }
+
+    XMLElement rootElem = xmlFile.GetRoot();
+    String globalVS = rootElem.GetAttribute("vs");
+    String globalPS = rootElem.GetAttribute("ps");
+    String globalVSDefines = rootElem.GetAttribute("vsdefines");
+    String globalPSDefines = rootElem.GetAttribute("psdefines");
+
+    for ( XMLElement passElem = rootElem.GetChild("pass"); passElem; passElem = passElem.GetNext("pass") )
+    {
+        PassVariant pass;
+
+        if (passElem.HasAttribute("vs"))
+        {
+            pass.vs_ = passElem.GetAttribute("vs");
+            pass.vsDefines_ = passElem.GetAttribute("vsdefines");
+        }
+        else
+        {
+            pass.vs_ = globalVS;
+            pass.vsDefines_ = AppendDefines(globalVSDefines, passElem.GetAttribute("vsdefines"));
+        }
+
+        if (passElem.HasAttribute("ps"))
+        {
+            pass.ps_ = passElem.GetAttribute("ps");
+            pass.psDefines_ = passElem.GetAttribute("psdefines");
+        }
+        else
+        {
+            pass.ps_ = globalPS;
+            pass.psDefines_ = AppendDefines(globalPSDefines, passElem.GetAttribute("psdefines"));
+        }
+
+        info.passNames_.Push(passElem.GetAttribute("name").ToLower());
+        info.passes_.Push(pass);
+    }
+
+    return true;
+}
+
+// Material::GetSpecular, the default MatSpecColor is black
+bool HasSpecular(const XMLElement &materialElem)
+{
+    for ( XMLElement paramElem = materialElem.GetChild("parameter"); paramElem; paramElem = paramElem.GetNext("parameter") )
+    {
+        if (paramElem.GetAttribute("name") == "MatSpecColor")
+        {
+            Vector4 color = ToVector4(paramElem.GetAttribute("value"), true);
+            return color.x_ > 0.0f || color.y_ > 0.0f || color.z_ > 0.0f;
+        }
+    }
+
+    return false;
+}
+
+bool IsLitPass(const String &passName)
+{
+    for ( unsigned i = 0; i < numLitPassNames; ++i )
+    {
+        if (passName == litPassNames[i])
+            return true;
+    }
+
+    return false;
+}
+
+//=============================================================================
+//=============================================================================
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+#ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+#else
+    arguments = ParseArguments(argc, argv);
+#endif
+
+    return Run(arguments);
+}
+
+int Run(Vector<String>& arguments)
+{
+    if (arguments.Size() < 1)
+    {
+        Help("Missing args, requires at least the material folder path\n");
+    }
+
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new Log(context));
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+
+    String materialPath = AddTrailingSlash(arguments[0]);
+    arguments.Erase(0);
+
+    String rootsArg;
+    String outputFile;
+    String mergeFile;
+    String api = "all";
+    String shadowDefine = "PCF_SHADOW";
+    bool addLightVariants = false;
+    bool verbose = false;
+
+    // parse args
+    while (arguments.Size() > 0)
+    {
+        String arg = arguments[0];
+        arguments.Erase(0);
+
+        if (arg.Empty())
+            continue;
+
+        if (arg.StartsWith("-"))
+        {
+                 if (arg == "-r" && arguments.Size()) { rootsArg = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-o" && arguments.Size()) { outputFile = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-m" && arguments.Size()) { mergeFile = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-a" && arguments.Size()) { api = arguments[0].ToLower(); arguments.Erase(0); }
+            else if (arg == "-s" && arguments.Size()) { shadowDefine = arguments[0]; arguments.Erase(0); }
+            else if (arg == "-l") { addLightVariants = true; }
+            else if (arg == "-v") { verbose = true; }
+            else if (arg == "-h") { Help(); }
+            else { Help("Unknown option: " + arg); }
+        }
+        else
+        {
+            Help("Wrong arg order?");
+        }
+    }
+
+    if (!fileSystem->DirExists(materialPath))
+    {
+        ErrorExit("material folder not found: " + materialPath);
+    }
+
+    Vector<String> roots;
+    if (rootsArg.Empty())
+    {
+        roots.Push(GetParentPath(materialPath));
+    }
+    else
+    {
+        Vector<String> rootList = rootsArg.Split(';');
+        for ( unsigned i = 0; i < rootList.Size(); ++i )
+        {
+            roots.Push(AddTrailingSlash(rootList[i].Trimmed()));
+        }
+    }
+
+    Vector<String> shaderDirs;
+    if (api == "all" || api == "glsl")
+        shaderDirs.Push("Shaders/GLSL/");
+    if (api == "all" || api == "hlsl")
+        shaderDirs.Push("Shaders/HLSL/");
+
+    Vector<String> materialFiles;
+    fileSystem->ScanDir(materialFiles, materialPath, "*.xml", SCAN_FILES, true);
+    Sort(materialFiles.Begin(), materialFiles.End());
+
+    HashMap<String, TechniqueInfo> techniques;
+    HashMap<String, bool> shaderFound;
+    HashSet<String> variantKeys;
+    Vector<PassVariant> variants;
+    unsigned numErrors = 0;
+    unsigned numMaterials = 0;
+
+    for ( unsigned i = 0; i < materialFiles.Size(); ++i )
+    {
+        XMLFile materialXML(context);
+
+        if (!LoadXML(context, materialPath + materialFiles[i], materialXML) || materialXML.GetRoot().GetName() != "material")
+        {
+            continue;
+        }
+
+        ++numMaterials;
+        XMLElement materialElem = materialXML.GetRoot();
+        unsigned numMaterialVariants = 0;
+
+        // material level defines are appended to every pass
+        XMLElement shaderElem = materialElem.GetChild("shader");
+        String materialVSDefines = shaderElem ? shaderElem.GetAttribute("vsdefines") : String::EMPTY;
+        String materialPSDefines = shaderElem ? shaderElem.GetAttribute("psdefines") : String::EMPTY;
+        bool specular = HasSpecular(materialElem);
+
+        for ( XMLElement techElem = materialElem.GetChild("technique"); techElem; techElem = techElem.GetNext("technique") )
+        {
+            String techName = techElem.GetAttribute("name");
+            HashMap<String, TechniqueInfo>::Iterator itr = techniques.Find(techName);
+
+            if (itr == techniques.End())
+            {
+                TechniqueInfo info;
+                String techPath = ResolvePath(fileSystem, roots, techName);
+                info.loaded_ = !techPath.Empty() && ParseTechnique(context, techPath, info);
+
+                if (!info.loaded_)
+                {
+                    PrintLine("error: " + materialFiles[i] + " references missing technique " + techName);
+                    ++numErrors;
+                }
+
+                itr = techniques.Insert(MakePair(techName, info));
+            }
+
+            const TechniqueInfo &info = itr->second_;
+
+            for ( unsigned p = 0; p < info.passes_.Size(); ++p )
+            {
+                PassVariant pass = info.passes_[p];
+                pass.vsDefines_ = AppendDefines(pass.vsDefines_, materialVSDefines);
+                pass.psDefines_ = AppendDefines(pass.psDefines_, materialPSDefines);
+
+                // validate the sources once per shader name
+                const String shaderNames[2] = { pass.vs_, pass.ps_ };
+                for ( unsigned s = 0; s < 2; ++s )
+                {
+                    for ( unsigned d = 0; d < shaderDirs.Size(); ++d )
+                    {
+                        String ext = shaderDirs[d].Contains("GLSL") ? ".glsl" : ".hlsl";
+                        String shaderFile = shaderDirs[d] + shaderNames[s] + ext;
+
+                        if (!shaderFound.Contains(shaderFile))
+                        {
+                            bool found = !ResolvePath(fileSystem, roots, shaderFile).Empty();
+                            shaderFound[shaderFile] = found;
+
+                            if (!found)
+                            {
+                                PrintLine("error: " + techName + " pass " + info.passNames_[p] + " uses missing " + shaderFile);
+                                ++numErrors;
+                            }
+                        }
+                    }
+                }
+
+                Vector<PassVariant> passVariants;
+
+                if (!IsLitPass(info.passNames_[p]))
+                {
+                    passVariants.Push(pass);
+                }
+                else if (addLightVariants)
+                {
+                    // light types, unshadowed then shadowed
+                    for ( unsigned l = 0; l < numLightTypes * 2; ++l )
+                    {
+                        bool shadowed = l >= numLightTypes;
+                        String lightDefines = lightTypeDefines[l % numLightTypes];
+                        PassVariant variant = pass;
+
+                        variant.vsDefines_ = AppendDefines(variant.vsDefines_, lightDefines);
+                        variant.psDefines_ = AppendDefines(variant.psDefines_, lightDefines);
+
+                        if (specular)
+                        {
+                            variant.psDefines_ = AppendDefines(variant.psDefines_, "SPECULAR");
+                        }
+                        if (shadowed)
+                        {
+                            variant.vsDefines_ = AppendDefines(variant.vsDefines_, "SHADOW");
+                            variant.psDefines_ = AppendDefines(variant.psDefines_, "SHADOW " + shadowDefine);
+                        }
+
+                        passVariants.Push(variant);
+                    }
+                }
+
+                for ( unsigned v = 0; v < passVariants.Size(); ++v )
+                {
+                    PassVariant variant = passVariants[v];
+                    variant.vsDefines_ = NormalizeDefines(variant.vsDefines_);
+                    variant.psDefines_ = NormalizeDefines(variant.psDefines_);
+
+                    String key = variant.vs_ + "|" + variant.vsDefines_ + "|" + variant.ps_ + "|" + variant.psDefines_;
+                    if (!variantKeys.Contains(key))
+                    {
+                        variantKeys.Insert(key);
+                        variants.Push(variant);
+                        ++numMaterialVariants;
+                    }
+                }
+            }
+        }
+
+        if (verbose)
+        {
+            PrintLine(materialFiles[i] + ": " + String(numMaterialVariants) + " new variants");
+        }
+    }
+
+    // recorded variants, same format as the output
+    unsigned numMerged = 0;
+    if (!mergeFile.Empty())
+    {
+        XMLFile mergeXML(context);
+
+        if (!LoadXML(context, mergeFile, mergeXML))
+        {
+            ErrorExit("failed to read " + mergeFile);
+        }
+
+        for ( XMLElement elem = mergeXML.GetRoot().GetChild("shader"); elem; elem = elem.GetNext("shader") )
+        {
+            PassVariant variant;
+            variant.vs_ = elem.GetAttribute("vs");
+            variant.vsDefines_ = NormalizeDefines(elem.GetAttribute("vsdefines"));
+            variant.ps_ = elem.GetAttribute("ps");
+            variant.psDefines_ = NormalizeDefines(elem.GetAttribute("psdefines"));
+
+            String key = variant.vs_ + "|" + variant.vsDefines_ + "|" + variant.ps_ + "|" + variant.psDefines_;
+            if (!variantKeys.Contains(key))
+            {
+                variantKeys.Insert(key);
+                variants.Push(variant);
+                ++numMerged;
+            }
+        }
+    }
+
+    XMLFile outXML(context);
+    XMLElement outRoot = outXML.CreateRoot("shaders");
+    HashMap<String, unsigned> shaderCounts;
+
+    for ( unsigned i = 0; i < variants.Size(); ++i )
+    {
+        XMLElement shaderElem = outRoot.CreateChild("shader");
+        shaderElem.SetAttribute("vs", variants[i].vs_);
+        shaderElem.SetAttribute("vsdefines", variants[i].vsDefines_);
+        shaderElem.SetAttribute("ps", variants[i].ps_);
+        shaderElem.SetAttribute("psdefines", variants[i].psDefines_);
+
+        ++shaderCounts[variants[i].ps_];
+    }
+
+    if (!outputFile.Empty())
+    {
+        File file(context, outputFile, FILE_WRITE);
+        if (!file.IsOpen() || !outXML.Save(file, "    "))
+        {
+            ErrorExit("failed to write " + outputFile);
+        }
+    }
+    else
+    {
+        VectorBuffer buffer;
+        outXML.Save(buffer, "    ");
+        PrintLine(String((const char*)buffer.GetData(), buffer.GetSize()));
+    }
+
+    // report
+    PrintLine(String(numMaterials) + " materials, " + String(techniques.Size()) + " techniques, " +
+              String(variants.Size()) + " variants (" + String(numMerged) + " merged), " + String(numErrors) + " errors");
+
+    if (verbose)
+    {
+        for (HashMap<String, unsigned>::ConstIterator itr = shaderCounts.Begin(); itr != shaderCounts.End(); ++itr)
+        {
+            PrintLine("  ps " + itr->first_ + ": " + String(itr->second_));
+        }
+    }
+
+    return numErrors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -5,21 +5,24 @@
 
 varying vec2 vScreenPos;
 
+#ifdef COMPILEVS
+// xy = min, zw = max of the glow screen rect in ndc, set per frame by GlowEffect
+uniform vec4 cGlowRect;
+#endif
+
 void VS()
 {
     mat4 modelMatrix = iModelMatrix;
     vec3 worldPos = GetWorldPos(modelMatrix);
+    // shrink the fullscreen quad to the glow rect
+    worldPos.xy = mix(cGlowRect.xy, cGlowRect.zw, worldPos.xy * 0.5 + 0.5);
     gl_Position = GetClipPos(worldPos);
     vScreenPos = GetScreenPosPreDiv(gl_Position);
 }
 
 void PS()
 {
-    vec4 finalColor =  texture2D(sDiffMap, vScreenPos);
-    vec4 glowCol = texture2D(sEnvMap, vScreenPos);
-
-    finalColor += glowCol;
-
-    gl_FragColor = finalColor;
+    // blended additively onto the viewport by the render path
+    gl_FragColor = texture2D(sEnvMap, vScreenPos);
 }
 
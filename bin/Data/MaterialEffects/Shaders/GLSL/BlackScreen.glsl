@@ -1,20 +0,0 @@
-#include "Uniforms.glsl"
-#include "Samplers.glsl"
-#include "Transform.glsl"
-#include "ScreenPos.glsl"
-
-varying vec2 vScreenPos;
-
-void VS()
-{
-    mat4 modelMatrix = iModelMatrix;
-    vec3 worldPos = GetWorldPos(modelMatrix);
-    gl_Position = GetClipPos(worldPos);
-    vScreenPos = GetScreenPosPreDiv(gl_Position);
-}
-
-void PS()
-{
-    gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
-}
-
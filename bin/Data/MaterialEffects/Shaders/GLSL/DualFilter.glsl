@@ -0,0 +1,54 @@
+#include "Uniforms.glsl"
+#include "Samplers.glsl"
+#include "Transform.glsl"
+#include "ScreenPos.glsl"
+
+varying vec2 vScreenPos;
+
+#ifdef COMPILEVS
+// xy = min, zw = max of the glow screen rect in ndc, set per frame by GlowEffect
+uniform vec4 cGlowRect;
+#endif
+#ifdef COMPILEPS
+// xy = 1 / input texture size, set per command by GlowEffect
+uniform vec2 cDualInvSize;
+uniform float cDualOffset;
+#endif
+
+void VS()
+{
+    mat4 modelMatrix = iModelMatrix;
+    vec3 worldPos = GetWorldPos(modelMatrix);
+    // shrink the fullscreen quad to the glow rect
+    worldPos.xy = mix(cGlowRect.xy, cGlowRect.zw, worldPos.xy * 0.5 + 0.5);
+    gl_Position = GetClipPos(worldPos);
+    vScreenPos = GetScreenPosPreDiv(gl_Position);
+}
+
+void PS()
+{
+    vec2 halfPixel = cDualInvSize * 0.5 * cDualOffset;
+
+    #ifdef DOWNSAMPLE
+    // center plus four diagonal bilinear taps, 5 fetches cover a 4x4 source area
+    vec4 sum = texture2D(sDiffMap, vScreenPos) * 4.0;
+    sum += texture2D(sDiffMap, vScreenPos - halfPixel);
+    sum += texture2D(sDiffMap, vScreenPos + halfPixel);
+    sum += texture2D(sDiffMap, vScreenPos + vec2(halfPixel.x, -halfPixel.y));
+    sum += texture2D(sDiffMap, vScreenPos - vec2(halfPixel.x, -halfPixel.y));
+    gl_FragColor = sum * (1.0 / 8.0);
+    #endif
+
+    #ifdef UPSAMPLE
+    // tent of four axis and four diagonal taps
+    vec4 sum = texture2D(sDiffMap, vScreenPos + vec2(-halfPixel.x * 2.0, 0.0));
+    sum += texture2D(sDiffMap, vScreenPos + vec2(-halfPixel.x, halfPixel.y)) * 2.0;
+    sum += texture2D(sDiffMap, vScreenPos + vec2(0.0, halfPixel.y * 2.0));
+    sum += texture2D(sDiffMap, vScreenPos + vec2(halfPixel.x, halfPixel.y)) * 2.0;
+    sum += texture2D(sDiffMap, vScreenPos + vec2(halfPixel.x * 2.0, 0.0));
+    sum += texture2D(sDiffMap, vScreenPos + vec2(halfPixel.x, -halfPixel.y)) * 2.0;
+    sum += texture2D(sDiffMap, vScreenPos + vec2(0.0, -halfPixel.y * 2.0));
+    sum += texture2D(sDiffMap, vScreenPos + vec2(-halfPixel.x, -halfPixel.y)) * 2.0;
+    gl_FragColor = sum * (1.0 / 12.0);
+    #endif
+}
@@ -6,6 +6,10 @@
 #include "Fog.glsl"
 
 uniform float cBRDFAttenuation;
+#ifdef BRDFATLAS
+    // x = row height, y = row offset, zw = v of the row's first and last texel centers, see BRDFAtlasBuilder
+    uniform vec4 cBRDFAtlasRow;
+#endif
 
 varying vec4 vEyeVec;
 varying vec2 vTexCoord;
@@ -38,7 +42,12 @@ vec4 GetBRDFMapColor(sampler2D brdfmap, vec3 normal, vec3 eyeVec, vec3 lightDir,
 
     // use the eqn as given in the reference if uv's are clamped - see MaterialEffects/Textures/fakeBRDF/brdfBlkRed.xml and brdfRainbow.xml
     float NdotV = dot(normal, eyeVec);
-    vec3 brdf = texture2D(brdfmap, vec2(NdotL, 1.0 - NdotV)).rgb;
+    vec2 brdfUV = vec2(NdotL, 1.0 - NdotV);
+    #ifdef BRDFATLAS
+        // shared atlas, stay inside the material's row
+        brdfUV.y = clamp(brdfUV.y * cBRDFAtlasRow.x + cBRDFAtlasRow.y, cBRDFAtlasRow.z, cBRDFAtlasRow.w);
+    #endif
+    vec3 brdf = texture2D(brdfmap, brdfUV).rgb;
      
     return vec4(brdf * atten, atten);
 }
@@ -112,5 +121,18 @@ void PS()
         float fogFactor = GetFogFactor(vWorldPos.w);
     #endif
 
-    gl_FragColor = vec4(GetLitFog(finalColor, fogFactor), 1.0);
+    #if defined(PREPASS)
+        // fake BRDF objects are not diffused by light, normal and depth are only written for the light buffer,
+        // the lookup is done in the material pass
+        gl_FragData[0] = vec4(normal * 0.5 + 0.5, 1.0);
+        gl_FragData[1] = vec4(EncodeDepth(vWorldPos.w), 0.0);
+    #elif defined(DEFERRED)
+        // the lookup goes to the accumulation buffer, black albedo keeps the light volumes from adding to it
+        gl_FragData[0] = vec4(GetFog(finalColor, fogFactor), 1.0);
+        gl_FragData[1] = vec4(0.0, 0.0, 0.0, 0.0);
+        gl_FragData[2] = vec4(normal * 0.5 + 0.5, 1.0);
+        gl_FragData[3] = vec4(EncodeDepth(vWorldPos.w), 0.0);
+    #else
+        gl_FragColor = vec4(GetLitFog(finalColor, fogFactor), 1.0);
+    #endif
 }
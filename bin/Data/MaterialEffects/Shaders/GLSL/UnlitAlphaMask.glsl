@@ -11,6 +11,11 @@ uniform float cMaskEdges;
 
 varying vec2 vTexCoord;
 varying vec4 vWorldPos;
+#ifdef SOFTPARTICLES
+    varying vec4 vScreenPos;
+    uniform float cSoftParticleFadeScale;
+    uniform float cAlphaCutoff;
+#endif
 #ifdef VERTEXCOLOR
     varying vec4 vColor;
 #endif
@@ -23,6 +28,10 @@ void VS()
     vTexCoord = GetTexCoord(iTexCoord);
     vWorldPos = vec4(worldPos, GetDepth(gl_Position));
 
+    #ifdef SOFTPARTICLES
+        vScreenPos = GetScreenPos(gl_Position);
+    #endif
+
     #ifdef VERTEXCOLOR
         vColor = iColor;
     #endif
@@ -38,6 +47,12 @@ void PS()
             float sumColor = diffColor.r + diffColor.g + diffColor.b;
             diffColor.a = clamp(sumColor - cMinSumColor, 0.0, min(cMaxAlpha, 1.0));
 
+            // drop masked out fragments before the remaining fetches
+            #ifdef SOFTPARTICLES
+                if (diffColor.a < cAlphaCutoff)
+                    discard;
+            #endif
+
             // add self emission
             if (cMultAddEmission > 0.0)
             {
@@ -58,6 +73,20 @@ void PS()
         diffColor *= vColor;
     #endif
 
+    // fade out where the quad intersects scene geometry
+    #ifdef SOFTPARTICLES
+        #ifdef HWDEPTH
+            float depth = ReconstructDepth(texture2DProj(sDepthBuffer, vScreenPos).r);
+        #else
+            float depth = DecodeDepth(texture2DProj(sDepthBuffer, vScreenPos).rgb);
+        #endif
+        float diffZ = (depth - vWorldPos.w) * (cFarClipPS - cNearClipPS);
+        diffColor.a *= clamp(diffZ * cSoftParticleFadeScale, 0.0, 1.0);
+
+        if (diffColor.a < cAlphaCutoff)
+            discard;
+    #endif
+
     // Get fog factor
     #ifdef HEIGHTFOG
         float fogFactor = GetHeightFogFactor(vWorldPos.w, vWorldPos.y);
@@ -7,24 +7,26 @@
 uniform float cMinSumColor;
 uniform float cMaxAlpha;
 uniform float cMultAddEmission;
-uniform float cMaskEdges;
-uniform vec2 cCurRowCol;
-uniform vec2 cMaxRowCol;
+// xy = 1 / (cols, rows), offset = (col, row) * frame size, set by UVSequencer
+uniform vec2 cFrameSize;
+uniform vec2 cFrameOffset;
 
 varying vec2 vFrameTexCoord;
 
 varying vec2 vTexCoord;
 varying vec4 vWorldPos;
+#ifdef SOFTPARTICLES
+    varying vec4 vScreenPos;
+    uniform float cSoftParticleFadeScale;
+    uniform float cAlphaCutoff;
+#endif
 #ifdef VERTEXCOLOR
     varying vec4 vColor;
 #endif
 
 vec2 GetFrameTexCoord(vec2 texCoord)
 {
-    float u = texCoord.x/cMaxRowCol.y + cCurRowCol.y/cMaxRowCol.y;
-    float v = texCoord.y/cMaxRowCol.x + cCurRowCol.x/cMaxRowCol.x;
-
-    return vec2(u, v);
+    return texCoord * cFrameSize + cFrameOffset;
 }
 
 void VS()
@@ -36,6 +38,10 @@ void VS()
     vFrameTexCoord = GetFrameTexCoord(iTexCoord);
     vWorldPos = vec4(worldPos, GetDepth(gl_Position));
 
+    #ifdef SOFTPARTICLES
+        vScreenPos = GetScreenPos(gl_Position);
+    #endif
+
     #ifdef VERTEXCOLOR
         vColor = iColor;
     #endif
@@ -51,17 +57,21 @@ void PS()
             float sumColor = diffColor.r + diffColor.g + diffColor.b;
             diffColor.a = clamp(sumColor - cMinSumColor, 0.0, min(cMaxAlpha, 1.0));
 
+            // drop masked out fragments before the remaining fetches
+            #ifdef SOFTPARTICLES
+                if (diffColor.a < cAlphaCutoff)
+                    discard;
+            #endif
+
             // add self emission
-            if (cMultAddEmission > 0.0)
-            {
+            #ifdef EMISSIONBOOST
                 diffColor.rgb *= (1.0 + cMultAddEmission);
-            }
+            #endif
 
             // clean up around the edges
-            if (cMaskEdges > 0.0)
-            {
+            #ifdef MASKEDGES
                 diffColor.a *= texture2D(sSpecMap, vTexCoord).a;
-            }
+            #endif
         #endif
     #else
         vec4 diffColor = cMatDiffColor;
@@ -71,6 +81,20 @@ void PS()
         diffColor *= vColor;
     #endif
 
+    // fade out where the quad intersects scene geometry
+    #ifdef SOFTPARTICLES
+        #ifdef HWDEPTH
+            float depth = ReconstructDepth(texture2DProj(sDepthBuffer, vScreenPos).r);
+        #else
+            float depth = DecodeDepth(texture2DProj(sDepthBuffer, vScreenPos).rgb);
+        #endif
+        float diffZ = (depth - vWorldPos.w) * (cFarClipPS - cNearClipPS);
+        diffColor.a *= clamp(diffZ * cSoftParticleFadeScale, 0.0, 1.0);
+
+        if (diffColor.a < cAlphaCutoff)
+            discard;
+    #endif
+
     // Get fog factor
     #ifdef HEIGHTFOG
         float fogFactor = GetHeightFogFactor(vWorldPos.w, vWorldPos.y);
@@ -19,7 +19,8 @@ void VS()
     gl_Position = GetClipPos(worldPos);
     //vTexCoord = GetTexCoord(iTexCoord);
     vWorldPos = vec4(worldPos, GetDepth(gl_Position));
-    vTexCoord = iTexCoord + cElapsedTime * cUVScrollSpeed;
+    // scene time is wrapped on the cpu, fract keeps the offset inside one repeat
+    vTexCoord = iTexCoord + fract(cElapsedTime * cUVScrollSpeed);
 
     #ifdef VERTEXCOLOR
         vColor = iColor;
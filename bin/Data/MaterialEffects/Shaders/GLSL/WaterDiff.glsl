@@ -11,6 +11,9 @@ varying vec4 vWaterUV;
 varying vec4 vEyeVec;
 varying vec2 vTexCoord;
 varying vec3 vWorldPos;
+#ifdef REFLREPROJECT
+varying float vReflectW;
+#endif
 #else
 varying highp vec4 vScreenPos;
 varying highp vec2 vReflectUV;
@@ -18,6 +21,9 @@ varying highp vec4 vWaterUV;
 varying highp vec4 vEyeVec;
 varying highp vec2 vTexCoord;
 varying highp vec3 vWorldPos;
+#ifdef REFLREPROJECT
+varying highp float vReflectW;
+#endif
 #endif
 varying vec3 vNormal;
 
@@ -25,6 +31,10 @@ varying vec3 vNormal;
 uniform vec4 cNoiseSpeed;
 uniform float cNoiseTiling;
 uniform float cDiffTiling;
+#ifdef REFLREPROJECT
+// main view-projection at the time the reflection was last rendered
+uniform mat4 cReflViewProj;
+#endif
 #endif
 #ifdef COMPILEPS
 uniform float cNoiseStrength;
@@ -43,11 +53,22 @@ void VS()
     // coordinate to make it work with arbitrary meshes such as the water plane (perform divide in pixel shader)
     // Also because the quadTexCoord is based on the clip position, and Y is flipped when rendering to a texture
     // on OpenGL, must flip again to cancel it out
-    vReflectUV = GetQuadTexCoord(gl_Position);
-    vReflectUV.y = 1.0 - vReflectUV.y;
-    vReflectUV *= gl_Position.w;
+    #ifdef REFLREPROJECT
+        // reflection may be a few frames old, look it up where this point was on screen when it was rendered
+        vec4 reflClipPos = vec4(worldPos, 1.0) * cReflViewProj;
+        vReflectUV = GetQuadTexCoord(reflClipPos);
+        vReflectUV.y = 1.0 - vReflectUV.y;
+        vReflectUV *= reflClipPos.w;
+        vReflectW = reflClipPos.w;
+    #else
+        vReflectUV = GetQuadTexCoord(gl_Position);
+        vReflectUV.y = 1.0 - vReflectUV.y;
+        vReflectUV *= gl_Position.w;
+    #endif
     vWaterUV.xy = iTexCoord * cNoiseTiling + cElapsedTime * cNoiseSpeed.xy;
-    vWaterUV.zw = iTexCoord * cNoiseTiling + cElapsedTime * cNoiseSpeed.zw;
+    #ifndef WATERLOW
+        vWaterUV.zw = iTexCoord * cNoiseTiling + cElapsedTime * cNoiseSpeed.zw;
+    #endif
     vNormal = GetWorldNormal(modelMatrix);
     vEyeVec = vec4(cCameraPos - worldPos, GetDepth(gl_Position));
     vTexCoord = GetTexCoord(iTexCoord) * cDiffTiling + cElapsedTime * cNoiseSpeed.xy;
@@ -56,11 +77,21 @@ void VS()
 void PS()
 {
     vec2 refractUV = vScreenPos.xy / vScreenPos.w;
-    vec2 reflectUV = vReflectUV.xy / vScreenPos.w;
+    #ifdef REFLREPROJECT
+        vec2 reflectUV = vReflectUV.xy / vReflectW;
+    #else
+        vec2 reflectUV = vReflectUV.xy / vScreenPos.w;
+    #endif
 
-    vec4 nbump = texture2D(sNormalMap, vWaterUV.xy);
-    vec4 nbump2 = texture2D(sNormalMap, vWaterUV.zw);
-    nbump = (nbump + nbump2) * 0.5;
+    #ifdef WATERLOW
+        // both layers in one fetch, rg and ba of the packed map hold two offset copies of the normal map
+        vec4 dualBump = texture2D(sEmissiveMap, vWaterUV.xy);
+        vec4 nbump = vec4((dualBump.rg + dualBump.ba) * 0.5, 1.0, 1.0);
+    #else
+        vec4 nbump = texture2D(sNormalMap, vWaterUV.xy);
+        vec4 nbump2 = texture2D(sNormalMap, vWaterUV.zw);
+        nbump = (nbump + nbump2) * 0.5;
+    #endif
     vec2 noise = (nbump.rg - 0.5) * cNoiseStrength;
     refractUV += noise;
     // Do not shift reflect UV coordinate upward, because it will reveal the clipping of geometry below water
@@ -68,16 +99,29 @@ void PS()
         noise.y = 0.0;
     reflectUV += noise;
 
-    float fresnel = pow(1.0 - clamp(dot(normalize(vEyeVec.xyz), vNormal), 0.0, 1.0), cFresnelPower);
+    #ifdef WATERLOW
+        // fixed power of 2, the FresnelPower of the demo materials
+        float fresnel = 1.0 - clamp(dot(normalize(vEyeVec.xyz), vNormal), 0.0, 1.0);
+        fresnel *= fresnel;
+    #else
+        float fresnel = pow(1.0 - clamp(dot(normalize(vEyeVec.xyz), vNormal), 0.0, 1.0), cFresnelPower);
+    #endif
     float fresBump = dot(vNormal, nbump.xyz);
     vec3 bumpWave = vec3(fresBump, fresBump, fresBump);
     vec4 diffColor = cMatDiffColor * texture2D(sDiffMap, vTexCoord);
     vec3 surfaceCol = mix(diffColor.rgb, bumpWave, cBumpWaveOpacity) * cWaterTint;
 
-    vec3 refractColor = texture2D(sEnvMap, refractUV).rgb * cWaterTint;
     vec3 reflectColor = texture2D(sSpecMap, reflectUV).rgb;
     vec3 finalColor = mix(surfaceCol, reflectColor, fresnel);
-    finalColor = mix(finalColor, refractColor, 1.0 - cMatDiffColor.a);
+
+    #ifdef WATERLOW
+        // opaque water skips the refraction fetch
+        if (cMatDiffColor.a < 1.0)
+            finalColor = mix(finalColor, texture2D(sEnvMap, refractUV).rgb * cWaterTint, 1.0 - cMatDiffColor.a);
+    #else
+        vec3 refractColor = texture2D(sEnvMap, refractUV).rgb * cWaterTint;
+        finalColor = mix(finalColor, refractColor, 1.0 - cMatDiffColor.a);
+    #endif
 
     gl_FragColor = vec4(GetFog(finalColor, GetFogFactor(vEyeVec.w)), 1.0);
 }
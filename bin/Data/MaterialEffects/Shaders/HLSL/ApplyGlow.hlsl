@@ -3,12 +3,31 @@
 #include "Transform.hlsl"
 #include "ScreenPos.hlsl"
 
+#ifdef COMPILEVS
+#ifndef D3D11
+
+// D3D9 uniforms
+// xy = min, zw = max of the glow screen rect in ndc, set per frame by GlowEffect
+uniform float4 cGlowRect;
+#else
+
+// D3D11 constant buffers
+cbuffer CustomVS : register(b6)
+{
+    float4 cGlowRect;
+}
+
+#endif
+#endif
+
 void VS(float4 iPos : POSITION,
     out float2 oScreenPos : TEXCOORD0,
     out float4 oPos : OUTPOSITION)
 {
     float4x3 modelMatrix = iModelMatrix;
     float3 worldPos = GetWorldPos(modelMatrix);
+    // shrink the fullscreen quad to the glow rect
+    worldPos.xy = lerp(cGlowRect.xy, cGlowRect.zw, worldPos.xy * 0.5 + 0.5);
     oPos = GetClipPos(worldPos);
     oScreenPos = GetScreenPosPreDiv(oPos);
 }
@@ -16,10 +35,6 @@ void VS(float4 iPos : POSITION,
 void PS(float2 iScreenPos : TEXCOORD0,
     out float4 oColor : OUTCOLOR0)
 {
-    float4 finalColor =  Sample2D(DiffMap, iScreenPos);
-    float4 glowCol = Sample2D(EnvMap, iScreenPos);
-
-    finalColor += glowCol;
-
-    oColor = finalColor;
+    // blended additively onto the viewport by the render path
+    oColor = Sample2D(EnvMap, iScreenPos);
 }
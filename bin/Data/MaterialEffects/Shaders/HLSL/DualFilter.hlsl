@@ -0,0 +1,71 @@
+#include "Uniforms.hlsl"
+#include "Samplers.hlsl"
+#include "Transform.hlsl"
+#include "ScreenPos.hlsl"
+
+#ifndef D3D11
+
+// D3D9 uniforms
+// xy = min, zw = max of the glow screen rect in ndc, set per frame by GlowEffect
+uniform float4 cGlowRect;
+uniform float2 cDualInvSize;
+uniform float cDualOffset;
+#else
+
+// D3D11 constant buffers
+#ifdef COMPILEVS
+cbuffer CustomVS : register(b6)
+{
+    float4 cGlowRect;
+}
+#else
+cbuffer CustomPS : register(b6)
+{
+    float2 cDualInvSize;
+    float cDualOffset;
+}
+#endif
+
+#endif
+
+void VS(float4 iPos : POSITION,
+    out float2 oScreenPos : TEXCOORD0,
+    out float4 oPos : OUTPOSITION)
+{
+    float4x3 modelMatrix = iModelMatrix;
+    float3 worldPos = GetWorldPos(modelMatrix);
+    // shrink the fullscreen quad to the glow rect
+    worldPos.xy = lerp(cGlowRect.xy, cGlowRect.zw, worldPos.xy * 0.5 + 0.5);
+    oPos = GetClipPos(worldPos);
+    oScreenPos = GetScreenPosPreDiv(oPos);
+}
+
+void PS(float2 iScreenPos : TEXCOORD0,
+    out float4 oColor : OUTCOLOR0)
+{
+    // xy = 1 / input texture size, set per command by GlowEffect
+    float2 halfPixel = cDualInvSize * 0.5 * cDualOffset;
+
+    #ifdef DOWNSAMPLE
+    // center plus four diagonal bilinear taps, 5 fetches cover a 4x4 source area
+    float4 sum = Sample2D(DiffMap, iScreenPos) * 4.0;
+    sum += Sample2D(DiffMap, iScreenPos - halfPixel);
+    sum += Sample2D(DiffMap, iScreenPos + halfPixel);
+    sum += Sample2D(DiffMap, iScreenPos + float2(halfPixel.x, -halfPixel.y));
+    sum += Sample2D(DiffMap, iScreenPos - float2(halfPixel.x, -halfPixel.y));
+    oColor = sum * (1.0 / 8.0);
+    #endif
+
+    #ifdef UPSAMPLE
+    // tent of four axis and four diagonal taps
+    float4 sum = Sample2D(DiffMap, iScreenPos + float2(-halfPixel.x * 2.0, 0.0));
+    sum += Sample2D(DiffMap, iScreenPos + float2(-halfPixel.x, halfPixel.y)) * 2.0;
+    sum += Sample2D(DiffMap, iScreenPos + float2(0.0, halfPixel.y * 2.0));
+    sum += Sample2D(DiffMap, iScreenPos + float2(halfPixel.x, halfPixel.y)) * 2.0;
+    sum += Sample2D(DiffMap, iScreenPos + float2(halfPixel.x * 2.0, 0.0));
+    sum += Sample2D(DiffMap, iScreenPos + float2(halfPixel.x, -halfPixel.y)) * 2.0;
+    sum += Sample2D(DiffMap, iScreenPos + float2(0.0, -halfPixel.y * 2.0));
+    sum += Sample2D(DiffMap, iScreenPos + float2(-halfPixel.x, -halfPixel.y)) * 2.0;
+    oColor = sum * (1.0 / 12.0);
+    #endif
+}
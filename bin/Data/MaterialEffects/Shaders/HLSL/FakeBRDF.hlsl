@@ -6,6 +6,10 @@
 #include "Fog.hlsl"
 
 uniform float cBRDFAttenuation;
+#ifdef BRDFATLAS
+    // x = row height, y = row offset, zw = v of the row's first and last texel centers, see BRDFAtlasBuilder
+    uniform float4 cBRDFAtlasRow;
+#endif
 
 //=============================================================================
 // reference
@@ -20,7 +24,12 @@ float4 GetBRDFMapColor(sampler2D brdfmap, float3 normal, float3 eyeVec, float3 l
 
     // use the eqn as given in the reference if uv's are clamped - see MaterialEffects/Textures/fakeBRDF/brdfBlkRed.xml and brdfRainbow.xml
     float NdotV = dot(normal, eyeVec);
-    float3 brdf = tex2D(brdfmap, float2(NdotL, 1.0 - NdotV)).rgb;
+    float2 brdfUV = float2(NdotL, 1.0 - NdotV);
+    #ifdef BRDFATLAS
+        // shared atlas, stay inside the material's row
+        brdfUV.y = clamp(brdfUV.y * cBRDFAtlasRow.x + cBRDFAtlasRow.y, cBRDFAtlasRow.z, cBRDFAtlasRow.w);
+    #endif
+    float3 brdf = tex2D(brdfmap, brdfUV).rgb;
      
     return float4(brdf * atten, atten);
 }
@@ -89,6 +98,14 @@ void PS(
             float4 iShadowPos[NUMCASCADES] : TEXCOORD4,
         #endif
     #endif
+    #ifdef PREPASS
+        out float4 oDepth : OUTCOLOR1,
+    #endif
+    #ifdef DEFERRED
+        out float4 oAlbedo : OUTCOLOR1,
+        out float4 oNormal : OUTCOLOR2,
+        out float4 oDepth : OUTCOLOR3,
+    #endif
     out float4 oColor : OUTCOLOR0)
 {
     // Get material diffuse albedo
@@ -131,7 +148,20 @@ void PS(
         float fogFactor = GetFogFactor(iWorldPos.w);
     #endif
 
-    oColor = float4(GetFog(finalColor, fogFactor), 1.0);
+    #if defined(PREPASS)
+        // fake BRDF objects are not diffused by light, normal and depth are only written for the light buffer,
+        // the lookup is done in the material pass
+        oColor = float4(normal * 0.5 + 0.5, 1.0);
+        oDepth = iWorldPos.w;
+    #elif defined(DEFERRED)
+        // the lookup goes to the accumulation buffer, black albedo keeps the light volumes from adding to it
+        oColor = float4(GetFog(finalColor, fogFactor), 1.0);
+        oAlbedo = float4(0.0, 0.0, 0.0, 0.0);
+        oNormal = float4(normal * 0.5 + 0.5, 1.0);
+        oDepth = iWorldPos.w;
+    #else
+        oColor = float4(GetFog(finalColor, fogFactor), 1.0);
+    #endif
 
 }
 
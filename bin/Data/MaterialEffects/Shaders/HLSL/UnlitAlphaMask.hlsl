@@ -1,11 +1,16 @@
 #include "Uniforms.hlsl"
 #include "Samplers.hlsl"
 #include "Transform.hlsl"
+#include "ScreenPos.hlsl"
 #include "Fog.hlsl"
 
 uniform float cMinSumColor;
 uniform float cMaxAlpha;
 uniform float cMultAddEmission;
+#ifdef SOFTPARTICLES
+uniform float cSoftParticleFadeScale;
+uniform float cAlphaCutoff;
+#endif
 uniform float cMaskEdges;
 
 void VS(float4 iPos : POSITION,
@@ -33,6 +38,9 @@ void VS(float4 iPos : POSITION,
     #endif
     out float2 oTexCoord : TEXCOORD0,
     out float4 oWorldPos : TEXCOORD2,
+    #ifdef SOFTPARTICLES
+        out float4 oScreenPos : TEXCOORD3,
+    #endif
     #ifdef VERTEXCOLOR
         out float4 oColor : COLOR0,
     #endif
@@ -52,6 +60,10 @@ void VS(float4 iPos : POSITION,
     oTexCoord = GetTexCoord(iTexCoord);
     oWorldPos = float4(worldPos, GetDepth(oPos));
 
+    #ifdef SOFTPARTICLES
+        oScreenPos = GetScreenPos(oPos);
+    #endif
+
     #if defined(D3D11) && defined(CLIPPLANE)
         oClip = dot(oPos, cClipPlane);
     #endif
@@ -63,6 +75,9 @@ void VS(float4 iPos : POSITION,
 
 void PS(float2 iTexCoord : TEXCOORD0,
     float4 iWorldPos: TEXCOORD2,
+    #ifdef SOFTPARTICLES
+        float4 iScreenPos: TEXCOORD3,
+    #endif
     #ifdef VERTEXCOLOR
         float4 iColor : COLOR0,
     #endif
@@ -87,6 +102,12 @@ void PS(float2 iTexCoord : TEXCOORD0,
             float sumColor = diffColor.r + diffColor.g + diffColor.b;
             diffColor.a = clamp(sumColor - cMinSumColor, 0.0, min(cMaxAlpha, 1.0));
 
+            // drop masked out fragments before the remaining fetches
+            #ifdef SOFTPARTICLES
+                if (diffColor.a < cAlphaCutoff)
+                    discard;
+            #endif
+
             // add self emission
             if (cMultAddEmission > 0.0)
             {
@@ -108,6 +129,20 @@ void PS(float2 iTexCoord : TEXCOORD0,
         diffColor *= iColor;
     #endif
 
+    // fade out where the quad intersects scene geometry
+    #ifdef SOFTPARTICLES
+        #ifdef HWDEPTH
+            float depth = ReconstructDepth(Sample2DProj(DepthBuffer, iScreenPos).r);
+        #else
+            float depth = Sample2DProj(DepthBuffer, iScreenPos).r;
+        #endif
+        float diffZ = (depth - iWorldPos.w) * (cFarClipPS - cNearClipPS);
+        diffColor.a *= saturate(diffZ * cSoftParticleFadeScale);
+
+        if (diffColor.a < cAlphaCutoff)
+            discard;
+    #endif
+
     // Get fog factor
     #ifdef HEIGHTFOG
         float fogFactor = GetHeightFogFactor(iWorldPos.w, iWorldPos.y);
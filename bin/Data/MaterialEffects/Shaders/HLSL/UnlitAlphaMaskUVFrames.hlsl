@@ -1,21 +1,23 @@
 #include "Uniforms.hlsl"
 #include "Samplers.hlsl"
 #include "Transform.hlsl"
+#include "ScreenPos.hlsl"
 #include "Fog.hlsl"
 
 uniform float cMinSumColor;
 uniform float cMaxAlpha;
 uniform float cMultAddEmission;
-uniform float cMaskEdges;
-uniform float2 cCurRowCol;
-uniform float2 cMaxRowCol;
+#ifdef SOFTPARTICLES
+uniform float cSoftParticleFadeScale;
+uniform float cAlphaCutoff;
+#endif
+// xy = 1 / (cols, rows), offset = (col, row) * frame size, set by UVSequencer
+uniform float2 cFrameSize;
+uniform float2 cFrameOffset;
 
 float2 GetFrameTexCoord(float2 texCoord)
 {
-    float u = texCoord.x/cMaxRowCol.y + cCurRowCol.y/cMaxRowCol.y;
-    float v = texCoord.y/cMaxRowCol.x + cCurRowCol.x/cMaxRowCol.x;
-
-    return float2(u, v);
+    return texCoord * cFrameSize + cFrameOffset;
 }
 
 
@@ -44,6 +46,9 @@ void VS(float4 iPos : POSITION,
     #endif
     out float2 oTexCoord : TEXCOORD0,
     out float4 oWorldPos : TEXCOORD2,
+    #ifdef SOFTPARTICLES
+        out float4 oScreenPos : TEXCOORD1,
+    #endif
     out float2 oFrameTexCoord : TEXCOORD3,
     #ifdef VERTEXCOLOR
         out float4 oColor : COLOR0,
@@ -66,6 +71,10 @@ void VS(float4 iPos : POSITION,
     oFrameTexCoord = GetFrameTexCoord(iTexCoord);
     oWorldPos = float4(worldPos, GetDepth(oPos));
 
+    #ifdef SOFTPARTICLES
+        oScreenPos = GetScreenPos(oPos);
+    #endif
+
     #if defined(D3D11) && defined(CLIPPLANE)
         oClip = dot(oPos, cClipPlane);
     #endif
@@ -77,6 +86,9 @@ void VS(float4 iPos : POSITION,
 
 void PS(float2 iTexCoord : TEXCOORD0,
     float4 iWorldPos: TEXCOORD2,
+    #ifdef SOFTPARTICLES
+        float4 iScreenPos: TEXCOORD1,
+    #endif
     float2 iFrameTexCoord: TEXCOORD3,
     #ifdef VERTEXCOLOR
         float4 iColor : COLOR0,
@@ -101,17 +113,21 @@ void PS(float2 iTexCoord : TEXCOORD0,
             float sumColor = diffColor.r + diffColor.g + diffColor.b;
             diffColor.a = clamp(sumColor - cMinSumColor, 0.0, min(cMaxAlpha, 1.0));
 
+            // drop masked out fragments before the remaining fetches
+            #ifdef SOFTPARTICLES
+                if (diffColor.a < cAlphaCutoff)
+                    discard;
+            #endif
+
             // add self emission
-            if (cMultAddEmission > 0.0)
-            {
+            #ifdef EMISSIONBOOST
                 diffColor.rgb *= (1.0 + cMultAddEmission);
-            }
+            #endif
 
             // clean up around the edges
-            if (cMaskEdges > 0.0)
-            {
+            #ifdef MASKEDGES
                 diffColor.a *= Sample2D(SpecMap, iTexCoord).a;
-            }
+            #endif
         #endif
     #else
         float4 diffColor = cMatDiffColor;
@@ -121,6 +137,20 @@ void PS(float2 iTexCoord : TEXCOORD0,
         diffColor *= iColor;
     #endif
 
+    // fade out where the quad intersects scene geometry
+    #ifdef SOFTPARTICLES
+        #ifdef HWDEPTH
+            float depth = ReconstructDepth(Sample2DProj(DepthBuffer, iScreenPos).r);
+        #else
+            float depth = Sample2DProj(DepthBuffer, iScreenPos).r;
+        #endif
+        float diffZ = (depth - iWorldPos.w) * (cFarClipPS - cNearClipPS);
+        diffColor.a *= saturate(diffZ * cSoftParticleFadeScale);
+
+        if (diffColor.a < cAlphaCutoff)
+            discard;
+    #endif
+
     // Get fog factor
     #ifdef HEIGHTFOG
         float fogFactor = GetHeightFogFactor(iWorldPos.w, iWorldPos.y);
@@ -47,7 +47,8 @@ void VS(float4 iPos : POSITION,
     float3 worldPos = GetWorldPos(modelMatrix);
     oPos = GetClipPos(worldPos);
     //oTexCoord = GetTexCoord(iTexCoord);
-    oTexCoord = iTexCoord + cElapsedTime * cUVScrollSpeed;
+    // scene time is wrapped on the cpu, frac keeps the offset inside one repeat
+    oTexCoord = iTexCoord + frac(cElapsedTime * cUVScrollSpeed);
     oWorldPos = float4(worldPos, GetDepth(oPos));
 
     #if defined(D3D11) && defined(CLIPPLANE)
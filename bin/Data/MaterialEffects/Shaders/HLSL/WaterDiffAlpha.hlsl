@@ -14,6 +14,9 @@ uniform float cFresnelPower;
 uniform float3 cWaterTint;
 uniform float cDiffTiling;
 uniform float cBumpWaveOpacity;
+#ifdef REFLREPROJECT
+uniform float4x4 cReflViewProj;
+#endif
 #else
 
 // D3D11 constant buffers
@@ -22,6 +25,9 @@ cbuffer CustomVS : register(b6)
 {
     float4 cNoiseSpeed;
     float cNoiseTiling;
+    #ifdef REFLREPROJECT
+    float4x4 cReflViewProj;
+    #endif
 }
 #else
 cbuffer CustomPS : register(b6)
@@ -46,6 +52,9 @@ void VS(float4 iPos : POSITION,
     out float4 oWaterUV : TEXCOORD2,
     out float3 oNormal : TEXCOORD3,
     out float4 oEyeVec : TEXCOORD4,
+    #ifdef REFLREPROJECT
+        out float oReflectW : TEXCOORD5,
+    #endif
     #if defined(D3D11) && defined(CLIPPLANE)
         out float oClip : SV_CLIPDISTANCE0,
     #endif
@@ -58,11 +67,22 @@ void VS(float4 iPos : POSITION,
     oScreenPos = GetScreenPos(oPos);
     // GetQuadTexCoord() returns a float2 that is OK for quad rendering; multiply it with output W
     // coordinate to make it work with arbitrary meshes such as the water plane (perform divide in pixel shader)
-    oReflectUV.xy = GetQuadTexCoord(oPos) * oPos.w;
+    #ifdef REFLREPROJECT
+        // reflection may be a few frames old, look it up where this point was on screen when it was rendered
+        float4 reflClipPos = mul(float4(worldPos, 1.0), cReflViewProj);
+        oReflectUV.xy = GetQuadTexCoord(reflClipPos) * reflClipPos.w;
+        oReflectW = reflClipPos.w;
+    #else
+        oReflectUV.xy = GetQuadTexCoord(oPos) * oPos.w;
+    #endif
 
     // water now has its own var and is vec4
     oWaterUV.xy = iTexCoord * cNoiseTiling + cElapsedTime * cNoiseSpeed.xy;
-    oWaterUV.zw = iTexCoord * cNoiseTiling + cElapsedTime * cNoiseSpeed.zw;
+    #ifndef WATERLOW
+        oWaterUV.zw = iTexCoord * cNoiseTiling + cElapsedTime * cNoiseSpeed.zw;
+    #else
+        oWaterUV.zw = 0.0;
+    #endif
     oNormal = GetWorldNormal(modelMatrix);
     oEyeVec = float4(cCameraPos - worldPos, GetDepth(oPos));
 
@@ -80,20 +100,33 @@ void PS(
     float4 iWaterUV : TEXCOORD2,
     float3 iNormal : TEXCOORD3,
     float4 iEyeVec : TEXCOORD4,
+    #ifdef REFLREPROJECT
+        float iReflectW : TEXCOORD5,
+    #endif
     #if defined(D3D11) && defined(CLIPPLANE)
         float iClip : SV_CLIPDISTANCE0,
     #endif
     out float4 oColor : OUTCOLOR0)
 {
     float2 refractUV = iScreenPos.xy / iScreenPos.w;
-    float2 reflectUV = iReflectUV.xy / iScreenPos.w;
+    #ifdef REFLREPROJECT
+        float2 reflectUV = iReflectUV.xy / iReflectW;
+    #else
+        float2 reflectUV = iReflectUV.xy / iScreenPos.w;
+    #endif
 
     // assign texcoord for clarity
     float2 iTexCoord = iReflectUV.zw;
 
-    float4 nbump = Sample2D(NormalMap, iWaterUV.xy);
-    float4 nbump2 = Sample2D(NormalMap, iWaterUV.zw);
-    nbump = (nbump + nbump2) * 0.5;
+    #ifdef WATERLOW
+        // both layers in one fetch, rg and ba of the packed map hold two offset copies of the normal map
+        float4 dualBump = Sample2D(EmissiveMap, iWaterUV.xy);
+        float4 nbump = float4((dualBump.rg + dualBump.ba) * 0.5, 1.0, 1.0);
+    #else
+        float4 nbump = Sample2D(NormalMap, iWaterUV.xy);
+        float4 nbump2 = Sample2D(NormalMap, iWaterUV.zw);
+        nbump = (nbump + nbump2) * 0.5;
+    #endif
     float2 noise = (nbump.rg - 0.5) * cNoiseStrength;
     refractUV += noise;
     // Do not shift reflect UV coordinate upward, because it will reveal the clipping of geometry below water
@@ -101,16 +134,29 @@ void PS(
         noise.y = 0.0;
     reflectUV += noise;
 
-    float fresnel = pow(1.0 - clamp(dot(normalize(iEyeVec.xyz), iNormal), 0.0, 1.0), cFresnelPower);
+    #ifdef WATERLOW
+        // fixed power of 2, the FresnelPower of the demo materials
+        float fresnel = 1.0 - clamp(dot(normalize(iEyeVec.xyz), iNormal), 0.0, 1.0);
+        fresnel *= fresnel;
+    #else
+        float fresnel = pow(1.0 - clamp(dot(normalize(iEyeVec.xyz), iNormal), 0.0, 1.0), cFresnelPower);
+    #endif
     float fresBump = dot(iNormal, nbump.xyz);
     float3 bumpWave = float3(fresBump, fresBump, fresBump);
     float4 diffColor = cMatDiffColor * Sample2D(DiffMap, iTexCoord);
     float3 surfaceCol = lerp(diffColor.rgb, bumpWave, cBumpWaveOpacity) * cWaterTint;
 
-    float3 refractColor = Sample2D(EnvMap, refractUV).rgb * cWaterTint;
     float3 reflectColor = Sample2D(SpecMap, reflectUV).rgb;
     float3 finalColor = lerp(surfaceCol, reflectColor, fresnel);
-    finalColor = lerp(finalColor, refractColor, 1.0 - cMatDiffColor.a);
+
+    #ifdef WATERLOW
+        // opaque water skips the refraction fetch
+        if (cMatDiffColor.a < 1.0)
+            finalColor = lerp(finalColor, Sample2D(EnvMap, refractUV).rgb * cWaterTint, 1.0 - cMatDiffColor.a);
+    #else
+        float3 refractColor = Sample2D(EnvMap, refractUV).rgb * cWaterTint;
+        finalColor = lerp(finalColor, refractColor, 1.0 - cMatDiffColor.a);
+    #endif
 
     oColor = float4(GetFog(finalColor, GetFogFactor(iEyeVec.w)), cMatDiffColor.a);
 }
\ No newline at end of file